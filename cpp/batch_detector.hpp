@@ -0,0 +1,450 @@
+#ifndef BATCH_DETECTOR_HPP
+#define BATCH_DETECTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "parallel_detector.hpp"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// A text read in place in the encoding it is stored in: UTF-8, Latin-1 (one byte
+// per code point, as CPython's 1-byte strings), UTF-16 or UTF-32. `length`
+// counts code units.
+struct BatchText {
+    enum class Encoding {
+        Utf8,
+        Latin1,
+        Utf16,
+        Utf32
+    };
+
+    const void* data;
+    size_t length;
+    Encoding encoding;
+
+    BatchText(std::string_view text) : data(text.data()), length(text.size()), encoding(Encoding::Utf8) {}
+    BatchText(const void* data, size_t length, Encoding encoding) : data(data), length(length), encoding(encoding) {}
+
+    size_t bytes() const {
+        switch (encoding) {
+            case Encoding::Utf16:
+                return length * sizeof(char16_t);
+            case Encoding::Utf32:
+                return length * sizeof(char32_t);
+            default:
+                return length;
+        }
+    }
+};
+
+// Batch detection over texts of very different sizes on a work-stealing pool.
+//
+// The batch is cut into tasks of similar cost first: texts of at least
+// 2 * CHUNK_SIZE bytes of UTF-8 are split at tokenizer split points (see
+// ParallelDetector::splitChunks) and their chunks' partial scores merged once
+// all are done, and runs of texts under GROUP_SIZE bytes are grouped so short
+// queries do not cost one task each. Tasks are sorted longest first and dealt
+// round-robin to one queue per worker. A worker takes tasks from the front of
+// its own queue and, once it is empty, steals from the back of the others'.
+// Each queue is a single atomic word (front and back index), so taking a task
+// is one compare-and-swap and no lock is held while scoring; every worker
+// scores into its own scratch PartialScore. Unsplit texts give exactly the
+// result of detectLanguage, split ones that of ParallelDetector. Task, queue
+// and thread lists are allocated from `memory`.
+class BatchDetector {
+public:
+    static constexpr size_t CHUNK_SIZE = 256 << 10;  // 256 KiB
+    static constexpr size_t GROUP_SIZE = 64 << 10;   // 64 KiB
+
+    // Writes the language of texts[i] to out[i]
+    static void detectLanguages(const std::string_view* texts, size_t n, Lang* out,
+                                size_t numThreads = defaultThreadCount(),
+                                std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        detectTexts(texts, n, out, numThreads, memory);
+    }
+
+    static void detectLanguages(const std::vector<std::string_view>& texts, Lang* out,
+                                size_t numThreads = defaultThreadCount(),
+                                std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        detectTexts(texts.data(), texts.size(), out, numThreads, memory);
+    }
+
+    // Same for texts in any BatchText encoding; only UTF-8 texts are split
+    static void detectLanguages(const BatchText* texts, size_t n, Lang* out,
+                                size_t numThreads = defaultThreadCount(),
+                                std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        detectTexts(texts, n, out, numThreads, memory);
+    }
+
+    // Language of one text, the same as detectLanguage on its UTF-8 form
+    static Lang detectLanguage(const BatchText& text) {
+        PartialScore partial;
+        addText(partial, text);
+        return partial.finalize();
+    }
+
+    // Threads the process may actually run on: the hardware threads, limited by
+    // the CPU affinity mask and by the smallest cgroup CPU quota (cpu.max in
+    // cgroup v2, cpu.cfs_quota_us / cpu.cfs_period_us in v1) rounded up, on the
+    // process's own cgroup (from /proc/self/cgroup) or its ancestors. Read once.
+    static size_t defaultThreadCount() {
+        static const size_t count = detectCpuLimit();
+        return count;
+    }
+
+private:
+    static constexpr size_t NONE = ~size_t(0);
+
+    template <typename Text>
+    static void detectTexts(const Text* texts, size_t n, Lang* out, size_t numThreads,
+                            std::pmr::memory_resource* memory) {
+        numThreads = std::max<size_t>(numThreads, 1);
+
+        std::pmr::vector<Task> tasks(memory);
+        std::pmr::vector<SplitText> splitTexts(memory);
+        std::pmr::vector<size_t> groupedTexts(memory);
+        size_t numChunks = 0;
+
+        // Tasks with the whole texts of groupedTexts[first, last), or one chunk
+        size_t groupStart = 0;
+        size_t groupBytes = 0;
+        auto closeGroup = [&]() {
+            if (groupStart < groupedTexts.size()) {
+                tasks.push_back({groupBytes, groupStart, groupedTexts.size(), 0, 0, 0, {}});
+            }
+            groupStart = groupedTexts.size();
+            groupBytes = 0;
+        };
+
+        for (size_t i = 0; i < n; ++i) {
+            std::string_view utf8;
+            if (numThreads > 1 && textBytes(texts[i]) >= 2 * CHUNK_SIZE && asUtf8(texts[i], utf8)) {
+                std::pmr::vector<ParallelDetector::Chunk> chunks =
+                    ParallelDetector::splitChunks(utf8, CHUNK_SIZE, memory);
+                splitTexts.push_back({i, numChunks, numChunks + chunks.size()});
+                for (const ParallelDetector::Chunk& chunk : chunks) {
+                    tasks.push_back({chunk.end - chunk.begin, i, 0, chunk.begin, chunk.end, numChunks++,
+                                     chunk.state});
+                }
+                continue;
+            }
+            groupedTexts.push_back(i);
+            groupBytes += textBytes(texts[i]);
+            if (groupBytes >= GROUP_SIZE) {
+                closeGroup();
+            }
+        }
+        closeGroup();
+
+        // Longest first, dealt round-robin so every queue is longest first too
+        std::stable_sort(tasks.begin(), tasks.end(), [](const Task& a, const Task& b) {
+            return a.bytes > b.bytes;
+        });
+        size_t numWorkers = std::min(numThreads, tasks.size());
+        if (numWorkers == 0) {
+            return;
+        }
+        std::pmr::vector<size_t> order(memory);
+        order.reserve(tasks.size());
+        std::pmr::vector<WorkQueue> queues(numWorkers, memory);
+        for (size_t w = 0; w < numWorkers; ++w) {
+            uint64_t front = order.size();
+            for (size_t t = w; t < tasks.size(); t += numWorkers) {
+                order.push_back(t);
+            }
+            queues[w].range.store(front | (static_cast<uint64_t>(order.size()) << 32), std::memory_order_relaxed);
+        }
+
+        std::pmr::vector<PartialScore> partials(numChunks, memory);
+
+        auto runTask = [&](const Task& task, PartialScore& scratch) {
+            if (task.last == 0) {
+                scratch = PartialScore();
+                std::string_view utf8;
+                asUtf8(texts[task.first], utf8);
+                LanguageDetector::TokenizerState state = task.state;
+                LanguageDetector::emitBuckets(utf8.data() + task.begin, task.end - task.begin, state,
+                                              [&](uint32_t bucket) {
+                    scratch.numFeatures++;
+                    LanguageDetector::addBucket(scratch.scores, bucket);
+                });
+                partials[task.slot] = scratch;
+                return;
+            }
+            for (size_t g = task.first; g < task.last; ++g) {
+                size_t i = groupedTexts[g];
+                scratch = PartialScore();
+                addText(scratch, texts[i]);
+                out[i] = scratch.finalize();
+            }
+        };
+
+        auto worker = [&](size_t self) {
+            PartialScore scratch;
+            size_t t;
+            while ((t = takeFront(queues[self])) != NONE) {
+                runTask(tasks[order[t]], scratch);
+            }
+            for (size_t offset = 1; offset < numWorkers; ++offset) {
+                WorkQueue& victim = queues[(self + offset) % numWorkers];
+                while ((t = stealBack(victim)) != NONE) {
+                    runTask(tasks[order[t]], scratch);
+                }
+            }
+        };
+
+        std::pmr::vector<std::thread> threads(memory);
+        threads.reserve(numWorkers - 1);
+        for (size_t w = 1; w < numWorkers; ++w) {
+            try {
+                threads.emplace_back(worker, w);
+            } catch (const std::system_error&) {
+                // Out of threads: the queues of the workers that did not start are
+                // stolen empty by the others, this thread included
+                break;
+            }
+        }
+        worker(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        for (const SplitText& split : splitTexts) {
+            PartialScore total;
+            for (size_t c = split.firstChunk; c < split.lastChunk; ++c) {
+                total.merge(partials[c]);
+            }
+            out[split.text] = total.finalize();
+        }
+    }
+
+    static size_t textBytes(std::string_view text) {
+        return text.size();
+    }
+
+    static size_t textBytes(const BatchText& text) {
+        return text.bytes();
+    }
+
+    // The text as UTF-8, false if it is in another encoding
+    static bool asUtf8(std::string_view text, std::string_view& utf8) {
+        utf8 = text;
+        return true;
+    }
+
+    static bool asUtf8(const BatchText& text, std::string_view& utf8) {
+        if (text.encoding != BatchText::Encoding::Utf8) {
+            return false;
+        }
+        utf8 = std::string_view(static_cast<const char*>(text.data), text.length);
+        return true;
+    }
+
+    static void addText(PartialScore& partial, std::string_view text) {
+        partial.add(text);
+    }
+
+    static void addText(PartialScore& partial, const BatchText& text) {
+        auto add = [&](uint32_t bucket) {
+            partial.numFeatures++;
+            LanguageDetector::addBucket(partial.scores, bucket);
+        };
+        switch (text.encoding) {
+            case BatchText::Encoding::Utf8:
+                partial.add(std::string_view(static_cast<const char*>(text.data), text.length));
+                break;
+            case BatchText::Encoding::Latin1: {
+                // Every byte is the code point itself
+                LanguageDetector::TokenizerState state;
+                const unsigned char* bytes = static_cast<const unsigned char*>(text.data);
+                for (size_t i = 0; i < text.length; ++i) {
+                    LanguageDetector::emitBuckets(static_cast<char32_t>(bytes[i]), state, add);
+                }
+                break;
+            }
+            case BatchText::Encoding::Utf16:
+                LanguageDetector::emitBuckets(std::u16string_view(static_cast<const char16_t*>(text.data), text.length),
+                                              add);
+                break;
+            case BatchText::Encoding::Utf32:
+                LanguageDetector::emitBuckets(std::u32string_view(static_cast<const char32_t*>(text.data), text.length),
+                                              add);
+                break;
+        }
+    }
+
+    struct Task {
+        size_t bytes;
+        size_t first;  // a group's first entry in groupedTexts, or the text of a chunk
+        size_t last;   // a group's end entry in groupedTexts, 0 for a chunk
+        size_t begin;  // chunk bytes
+        size_t end;
+        size_t slot;   // chunk index into the partial scores
+        LanguageDetector::TokenizerState state;
+    };
+
+    struct SplitText {
+        size_t text;
+        size_t firstChunk;
+        size_t lastChunk;
+    };
+
+    // Front index in the low, back index in the high 32 bits, so both ends are
+    // taken with one compare-and-swap. Padded to a cache line of its own.
+    struct alignas(64) WorkQueue {
+        std::atomic<uint64_t> range{0};
+    };
+
+    static size_t takeFront(WorkQueue& queue) {
+        uint64_t range = queue.range.load(std::memory_order_relaxed);
+        while (static_cast<uint32_t>(range) < static_cast<uint32_t>(range >> 32)) {
+            if (queue.range.compare_exchange_weak(range, range + 1, std::memory_order_acq_rel)) {
+                return static_cast<uint32_t>(range);
+            }
+        }
+        return NONE;
+    }
+
+    static size_t stealBack(WorkQueue& queue) {
+        uint64_t range = queue.range.load(std::memory_order_relaxed);
+        while (static_cast<uint32_t>(range) < static_cast<uint32_t>(range >> 32)) {
+            if (queue.range.compare_exchange_weak(range, range - (uint64_t(1) << 32), std::memory_order_acq_rel)) {
+                return static_cast<uint32_t>(range >> 32) - 1;
+            }
+        }
+        return NONE;
+    }
+
+    // Number in whitespace-separated field `field` of `path`, or 0 if it is
+    // missing or not a number ("max")
+    static long long readNumber(const std::string& path, size_t field = 0) {
+        std::ifstream file(path);
+        std::string value;
+        for (size_t i = 0; i <= field; ++i) {
+            if (!(file >> value)) {
+                return 0;
+            }
+        }
+        char* end = nullptr;
+        long long number = std::strtoll(value.c_str(), &end, 10);
+        return end != value.c_str() && *end == '\0' ? number : 0;
+    }
+
+    static size_t detectCpuLimit() {
+        size_t count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+#ifdef __linux__
+        cpu_set_t set;
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            count = std::min<size_t>(count, std::max(CPU_COUNT(&set), 1));
+        }
+
+        size_t limit = cgroupCpuLimit("/proc/self/cgroup", "/proc/self/mountinfo");
+        if (limit > 0) {
+            count = std::min(count, limit);
+        }
+#endif
+        return count;
+    }
+
+#ifdef __linux__
+    // Smallest CPU quota, in CPUs rounded up, set on the process's own cgroup or
+    // any of its ancestors, for the cgroup v2 and the v1 cpu controller; 0 if
+    // there is none. `cgroupFile` and `mountInfo` are the /proc/self files.
+    static size_t cgroupCpuLimit(const std::string& cgroupFile, const std::string& mountInfo) {
+        size_t limit = 0;
+        std::ifstream cgroups(cgroupFile);
+        std::string line;
+        while (std::getline(cgroups, line)) {
+            // hierarchy-ID:controller-list:path, with an empty list for v2
+            size_t first = line.find(':');
+            size_t second = first == std::string::npos ? first : line.find(':', first + 1);
+            if (second == std::string::npos) {
+                continue;
+            }
+            std::string controllers = line.substr(first + 1, second - first - 1);
+            bool v2 = controllers.empty();
+            if (!v2 && !hasOption(controllers, "cpu")) {
+                continue;
+            }
+            std::string mountPoint;
+            std::string mountRoot;
+            if (!findCgroupMount(mountInfo, v2, mountPoint, mountRoot)) {
+                continue;
+            }
+
+            // The path is relative to the hierarchy's root, the mount may show a subtree of it
+            std::string path = line.substr(second + 1);
+            if (mountRoot != "/" && path.compare(0, mountRoot.size(), mountRoot) == 0) {
+                path = path.substr(mountRoot.size());
+            }
+            while (true) {
+                std::string directory = mountPoint + (path == "/" ? "" : path);
+                long long quota = readNumber(directory + (v2 ? "/cpu.max" : "/cpu.cfs_quota_us"));
+                long long period = v2 ? readNumber(directory + "/cpu.max", 1)
+                                      : readNumber(directory + "/cpu.cfs_period_us");
+                if (quota > 0 && period > 0) {
+                    size_t cpus = static_cast<size_t>(std::max<long long>((quota + period - 1) / period, 1));
+                    limit = limit == 0 ? cpus : std::min(limit, cpus);
+                }
+                size_t slash = path.find_last_of('/');
+                if (path.size() <= 1 || slash == std::string::npos) {
+                    break;
+                }
+                path.resize(slash);
+            }
+        }
+        return limit;
+    }
+
+    // Mount point and root of the cgroup2 hierarchy, or of the v1 hierarchy with
+    // the cpu controller, from /proc/self/mountinfo:
+    //   id parent major:minor root mount-point options [optional...] - type source super-options
+    static bool findCgroupMount(const std::string& mountInfo, bool v2, std::string& mountPoint,
+                                std::string& mountRoot) {
+        std::ifstream mounts(mountInfo);
+        std::string line;
+        while (std::getline(mounts, line)) {
+            std::istringstream fields(line);
+            std::string id, parent, device, root, point, field;
+            fields >> id >> parent >> device >> root >> point;
+            while (fields >> field && field != "-") {
+            }
+            std::string type, source, options;
+            fields >> type >> source >> options;
+            if (v2 ? type == "cgroup2" : type == "cgroup" && hasOption(options, "cpu")) {
+                mountPoint = point;
+                mountRoot = root;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Whether the comma-separated `list` contains `option`
+    static bool hasOption(const std::string& list, const std::string& option) {
+        size_t begin = 0;
+        while (begin <= list.size()) {
+            size_t end = std::min(list.find(',', begin), list.size());
+            if (list.compare(begin, end - begin, option) == 0) {
+                return true;
+            }
+            begin = end + 1;
+        }
+        return false;
+    }
+#endif
+};
+
+#endif // BATCH_DETECTOR_HPP
@@ -0,0 +1,45 @@
+"""Benchmark of whichlang.detect_many against a per-string Python loop.
+
+Build the extension first (see whichlang_python.cpp), then run:
+    python3 bench_python.py [num_texts] [threads]
+"""
+import sys
+import time
+
+import whichlang
+
+SAMPLES = [
+    "The quick brown fox jumps over the lazy dog.",
+    "Der schnelle braune Fuchs springt über den faulen Hund.",
+    "El rápido zorro marrón salta sobre el perro perezoso.",
+    "Le renard brun rapide saute par-dessus le chien paresseux.",
+    "素早い茶色の狐がのろまな犬を飛び越える。",
+    "Быстрая коричневая лиса прыгает через ленивую собаку.",
+    b"De snelle bruine vos springt over de luie hond.",
+]
+
+
+def main():
+    num_texts = int(sys.argv[1]) if len(sys.argv) > 1 else 1_000_000
+    threads = int(sys.argv[2]) if len(sys.argv) > 2 else 0
+    texts = [SAMPLES[i % len(SAMPLES)] for i in range(num_texts)]
+
+    start = time.perf_counter()
+    loop = [whichlang.detect(text) for text in texts]
+    loop_seconds = time.perf_counter() - start
+
+    start = time.perf_counter()
+    indices = whichlang.detect_many(texts, threads=threads)
+    bulk_seconds = time.perf_counter() - start
+
+    bulk = [whichlang.LANGUAGES[i] for i in indices]
+    assert bulk == loop, "detect_many disagrees with detect"
+
+    print(f"{num_texts} texts")
+    print(f"per-string loop: {loop_seconds:8.3f} s  {num_texts / loop_seconds:12.0f} texts/s")
+    print(f"detect_many:     {bulk_seconds:8.3f} s  {num_texts / bulk_seconds:12.0f} texts/s"
+          f"  ({loop_seconds / bulk_seconds:.1f}x)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,29 @@
+-- Benchmark of the whichlang() SQLite extension on a generated table.
+--
+-- Build whichlang.so (see whichlang_sqlite.cpp), then run:
+--   sqlite3 :memory: < bench_sqlite.sql
+-- The first UPDATE only measures SQLite's own per-row cost, for comparison.
+.load ./whichlang
+
+CREATE TABLE samples(id INTEGER PRIMARY KEY, body TEXT);
+INSERT INTO samples(body) VALUES
+    ('The quick brown fox jumps over the lazy dog.'),
+    ('Der schnelle braune Fuchs springt über den faulen Hund.'),
+    ('El rápido zorro marrón salta sobre el perro perezoso.'),
+    ('Le renard brun rapide saute par-dessus le chien paresseux.'),
+    ('素早い茶色の狐がのろまな犬を飛び越える。'),
+    ('Быстрая коричневая лиса прыгает через ленивую собаку.'),
+    ('De snelle bruine vos springt over de luie hond.');
+
+CREATE TABLE docs(id INTEGER PRIMARY KEY, body TEXT, lang TEXT);
+INSERT INTO docs(id, body)
+    WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < 2000000)
+    SELECT i, (SELECT body FROM samples WHERE id = i % 7 + 1) || ' #' || i FROM n;
+
+.timer on
+UPDATE docs SET lang = substr(body, 1, 2);
+UPDATE docs SET lang = whichlang(body);
+.timer off
+
+SELECT lang, count(*) FROM docs GROUP BY lang ORDER BY lang;
+SELECT json_extract(whichlang_scores(body), '$.de') FROM docs WHERE id = 1;
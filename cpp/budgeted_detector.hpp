@@ -0,0 +1,116 @@
+#ifndef BUDGETED_DETECTOR_HPP
+#define BUDGETED_DETECTOR_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory_resource>
+#include <string_view>
+#include "parallel_detector.hpp"
+#include "sampled_detector.hpp"
+
+struct DetectionBudget {
+    size_t maxBytes = std::numeric_limits<size_t>::max();
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+};
+
+struct BudgetedResult {
+    Lang language;
+    bool partial;      // true if part of the text was not scored
+    size_t bytesUsed;  // bytes of the text that were scored
+};
+
+// detectLanguage with a byte budget and/or a deadline, returning the best answer
+// found within them.
+//
+// A text larger than the byte budget is sampled in three evenly spaced windows
+// (head, middle and tail, see SampledDetector) that share the budget, so
+// boilerplate at either end does not decide the result on its own. With a
+// deadline, a text within the byte budget is cut into its head, middle and tail
+// thirds at tokenizer split points (see ParallelDetector::splitChunks), which
+// together cover it. Only without either limit is the text a single window.
+//
+// The windows are scored in round-robin slices of SLICE_SIZE bytes and the
+// deadline is checked between slices, so running out of time still leaves a
+// sample spread over the whole text. The first slice of every window is always
+// scored. The windows live in a buffer on the stack, so nothing is allocated.
+class BudgetedDetector {
+public:
+    static constexpr size_t SLICE_SIZE = 4096;
+
+    static BudgetedResult detectLanguage(std::string_view text, const DetectionBudget& budget) {
+        std::array<std::byte, WINDOW_BUFFER_SIZE> buffer;
+        std::pmr::monotonic_buffer_resource stack(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+        std::pmr::vector<TextWindow> windows(&stack);
+        bool checkDeadline = budget.deadline != std::chrono::steady_clock::time_point::max();
+        if (text.size() > budget.maxBytes) {
+            windows = SampledDetector::placeWindows(text, NUM_WINDOWS, budget.maxBytes / NUM_WINDOWS,
+                                                    SampledDetector::Placement::Even, 0, &stack);
+        } else if (checkDeadline) {
+            // Head, middle and tail thirds cut at split points, so the slices cover
+            // the whole text and a timeout still leaves a spread sample
+            size_t third = std::max<size_t>((text.size() + NUM_WINDOWS - 1) / NUM_WINDOWS, 1);
+            windows.reserve(NUM_WINDOWS);
+            for (const ParallelDetector::Chunk& chunk : ParallelDetector::splitChunks(text, third, &stack)) {
+                windows.push_back({chunk.begin, chunk.end, chunk.state});
+            }
+        } else {
+            windows.push_back({0, text.size(), LanguageDetector::TokenizerState()});
+        }
+
+        PartialScore partial;
+        size_t bytesUsed = 0;
+        bool outOfTime = false;
+        bool firstRound = true;
+
+        for (bool active = true; active && !outOfTime; firstRound = false) {
+            active = false;
+            for (TextWindow& window : windows) {
+                if (window.begin >= window.end) {
+                    continue;
+                }
+                if (!firstRound && checkDeadline && std::chrono::steady_clock::now() >= budget.deadline) {
+                    outOfTime = true;
+                    break;
+                }
+
+                size_t length = std::min(SLICE_SIZE, window.end - window.begin);
+                size_t consumed = LanguageDetector::emitBuckets(text.data() + window.begin, length, window.state,
+                                                                [&](uint32_t bucket) {
+                    partial.numFeatures++;
+                    LanguageDetector::addBucket(partial.scores, bucket);
+                });
+                if (consumed == 0) {
+                    // Only a cut off sequence is left, which the decoder drops
+                    consumed = window.end - window.begin;
+                }
+                window.begin += consumed;
+                bytesUsed += consumed;
+                active = active || window.begin < window.end;
+            }
+        }
+
+        return {partial.finalize(), bytesUsed < text.size(), bytesUsed};
+    }
+
+    static BudgetedResult detectLanguage(std::string_view text, size_t maxBytes) {
+        DetectionBudget budget;
+        budget.maxBytes = maxBytes;
+        return detectLanguage(text, budget);
+    }
+
+    static BudgetedResult detectLanguage(std::string_view text, std::chrono::steady_clock::time_point deadline) {
+        DetectionBudget budget;
+        budget.deadline = deadline;
+        return detectLanguage(text, budget);
+    }
+
+private:
+    static constexpr size_t NUM_WINDOWS = 3;
+    // Room for the growth steps of a vector of up to NUM_WINDOWS windows, or of
+    // up to NUM_WINDOWS chunks plus the windows made from them
+    static constexpr size_t WINDOW_BUFFER_SIZE = 8 * NUM_WINDOWS * sizeof(TextWindow);
+};
+
+#endif // BUDGETED_DETECTOR_HPP
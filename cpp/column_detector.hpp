@@ -0,0 +1,105 @@
+#ifndef COLUMN_DETECTOR_HPP
+#define COLUMN_DETECTOR_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "language_detector.hpp"
+
+// Batch detection over a string column in the Arrow layout: one contiguous
+// UTF-8 buffer and n + 1 offsets, row i being data[offsets[i], offsets[i + 1]).
+//
+// Rows are read in place and results go to caller-provided columns: outLang[i]
+// is the index of the row's language in LANGUAGES, and outScores, if not null,
+// receives the row's NUM_LANGUAGES final scores at outScores[i * NUM_LANGUAGES].
+// A row without features gets the English fallback and all-zero scores. Row
+// ranges of ROWS_PER_TASK rows are handed out to the threads from an atomic
+// counter. Every row gives exactly the result of detectLanguage on it.
+class ColumnDetector {
+public:
+    static constexpr size_t ROWS_PER_TASK = 1024;
+
+    static void detectColumn(const char* data, const int64_t* offsets, size_t n, uint8_t* outLang,
+                             float* outScores = nullptr,
+                             size_t numThreads = std::thread::hardware_concurrency()) {
+        detectRows(data, offsets, n, outLang, outScores, numThreads);
+    }
+
+    static void detectColumn(const char* data, const int32_t* offsets, size_t n, uint8_t* outLang,
+                             float* outScores = nullptr,
+                             size_t numThreads = std::thread::hardware_concurrency()) {
+        detectRows(data, offsets, n, outLang, outScores, numThreads);
+    }
+
+    // Language of an outLang entry
+    static Lang language(uint8_t index) {
+        return LANGUAGES[index];
+    }
+
+private:
+    static constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+    static_assert(NUM_LANGUAGES <= 256, "languages are written as uint8_t indices");
+
+    template <typename Offset>
+    static void detectRows(const char* data, const Offset* offsets, size_t n, uint8_t* outLang, float* outScores,
+                           size_t numThreads) {
+        size_t numTasks = (n + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+        std::atomic<size_t> nextTask{0};
+
+        auto worker = [&]() {
+            for (size_t task = nextTask++; task < numTasks; task = nextTask++) {
+                size_t end = std::min(n, (task + 1) * ROWS_PER_TASK);
+                for (size_t row = task * ROWS_PER_TASK; row < end; ++row) {
+                    detectRow(data + offsets[row], static_cast<size_t>(offsets[row + 1] - offsets[row]),
+                              outLang[row], outScores ? outScores + row * NUM_LANGUAGES : nullptr);
+                }
+            }
+        };
+
+        std::vector<std::thread> threads;
+        size_t numWorkers = std::min(std::max<size_t>(numThreads, 1), numTasks);
+        threads.reserve(numWorkers > 0 ? numWorkers - 1 : 0);
+        for (size_t t = 1; t < numWorkers; ++t) {
+            try {
+                threads.emplace_back(worker);
+            } catch (const std::system_error&) {
+                // Out of threads: the started ones and this one take the remaining rows
+                break;
+            }
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    static void detectRow(const char* text, size_t length, uint8_t& outLang, float* outScores) {
+        std::array<float, NUM_LANGUAGES> scores{};
+        uint32_t numFeatures = 0;
+        LanguageDetector::TokenizerState state;
+
+        LanguageDetector::emitBuckets(text, length, state, [&](uint32_t bucket) {
+            numFeatures++;
+            LanguageDetector::addBucket(scores, bucket);
+        });
+
+        if (numFeatures == 0) {
+            // Default to English
+            static const uint8_t ENGLISH = static_cast<uint8_t>(
+                std::distance(LANGUAGES.begin(), std::find(LANGUAGES.begin(), LANGUAGES.end(), Lang::En)));
+            outLang = ENGLISH;
+        } else {
+            LanguageDetector::normalizeScores(scores, numFeatures);
+            outLang = static_cast<uint8_t>(std::distance(scores.begin(),
+                                                         std::max_element(scores.begin(), scores.end())));
+        }
+        if (outScores != nullptr) {
+            std::copy(scores.begin(), scores.end(), outScores);
+        }
+    }
+};
+
+#endif // COLUMN_DETECTOR_HPP
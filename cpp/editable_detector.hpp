@@ -0,0 +1,280 @@
+#ifndef EDITABLE_DETECTOR_HPP
+#define EDITABLE_DETECTOR_HPP
+
+#include <array>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "partial_score.hpp"
+
+// Detector for a document that is edited in place (editor integrations that
+// re-detect after every keystroke).
+//
+// The text is kept as a list of segments of about `segmentSize` bytes that start
+// at split points (see LanguageDetector::findSplitPoint), so every segment can be
+// tokenized without the text before it. Each segment stores its partial sums and
+// the document keeps their running total. An edit re-tokenizes only the segments
+// it touches, plus the next one if the edit changed the bytes its split point
+// depends on, and updates the total by subtracting the old partials and adding
+// the new ones. The total is kept in doubles so repeated updates do not drift.
+//
+// The text is a gap buffer and the segment lengths are indexed by a Fenwick
+// tree, so an edit costs O(log segments) to find its segments, O(edit +
+// segmentSize) to re-tokenize them, and moving the gap costs the distance from
+// the previous edit. Edits that change the number of segments also shift the
+// segment list and rebuild the index, O(size / segmentSize), which typing only
+// hits about once per segmentSize bytes. text() closes the gap, which costs the
+// distance from the last edit to the end. The text and the segment lists are
+// allocated from `memory`.
+class EditableDetector {
+public:
+    static constexpr size_t DEFAULT_SEGMENT_SIZE = 1024;
+
+    explicit EditableDetector(std::string_view text = std::string_view(), size_t segmentSize = DEFAULT_SEGMENT_SIZE,
+                              std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : buffer(text, memory), gapBegin(text.size()), segmentSize(std::max<size_t>(segmentSize, 16)),
+          segments(memory), index(memory) {
+        segments = splitRegion(0, size(), LanguageDetector::TokenizerState());
+        for (const Segment& segment : segments) {
+            addPartial(segment.partial, 1.0);
+        }
+        rebuildIndex();
+    }
+
+    // Replaces text[pos, pos + length) by `replacement` and returns the language
+    // of the edited document. Out-of-range positions are clamped to the text.
+    Lang replace(size_t pos, size_t length, std::string_view replacement) {
+        pos = std::min(pos, size());
+        length = std::min(length, size() - pos);
+
+        // Start one byte before the edit so the first boundary kept depends only
+        // on unchanged bytes
+        size_t regionBegin;
+        size_t first = findSegment(pos > 0 ? pos - 1 : 0, regionBegin);
+        size_t lastBegin;
+        size_t last = findSegment(pos + length, lastBegin);
+        size_t regionEnd = lastBegin + segments[last].length - length + replacement.size();
+
+        // The removed bytes join the gap, the replacement is written at its start
+        moveGap(pos);
+        gapLength += length;
+        reserveGap(replacement.size());
+        std::memcpy(&buffer[gapBegin], replacement.data(), replacement.size());
+        gapBegin += replacement.size();
+        gapLength -= replacement.size();
+
+        // Everything read from here on is at or after the region, minus the
+        // look-back of findSplitPoint, so park the gap in front of it
+        moveGap(regionBegin > SPLIT_LOOKBACK ? regionBegin - SPLIT_LOOKBACK : 0);
+
+        // Extend the region while the next boundary is no longer a split point
+        // with the same state, and absorb neighbours of a region that got too small
+        size_t end = last + 1;
+        while (end < segments.size()) {
+            LanguageDetector::TokenizerState state;
+            size_t split = LanguageDetector::findSplitPoint(tail(), size(), regionEnd, regionEnd + 1, state);
+            bool keepBoundary = split == regionEnd
+                                && state.prev == segments[end].state.prev
+                                && state.numPreviousAsciiChr == segments[end].state.numPreviousAsciiChr
+                                && regionEnd - regionBegin >= segmentSize / 4;
+            if (keepBoundary) {
+                break;
+            }
+            regionEnd += segments[end].length;
+            end++;
+        }
+
+        LanguageDetector::TokenizerState state = segments[first].state;
+        for (size_t s = first; s < end; ++s) {
+            addPartial(segments[s].partial, -1.0);
+        }
+        std::pmr::vector<Segment> replaced = splitRegion(regionBegin, regionEnd, state);
+        for (const Segment& segment : replaced) {
+            addPartial(segment.partial, 1.0);
+        }
+        if (replaced.size() == end - first) {
+            // Same number of segments: overwrite them and update the index in place
+            for (size_t s = first; s < end; ++s) {
+                addLength(s, replaced[s - first].length - segments[s].length);
+                segments[s] = replaced[s - first];
+            }
+        } else {
+            segments.erase(segments.begin() + first, segments.begin() + end);
+            segments.insert(segments.begin() + first, replaced.begin(), replaced.end());
+            rebuildIndex();
+        }
+
+        return language();
+    }
+
+    Lang insert(size_t pos, std::string_view insertion) {
+        return replace(pos, 0, insertion);
+    }
+
+    Lang erase(size_t pos, size_t length) {
+        return replace(pos, length, std::string_view());
+    }
+
+    Lang language() const {
+        std::array<float, LanguageDetector::NUM_LANGUAGES> scores;
+        for (size_t i = 0; i < scores.size(); ++i) {
+            scores[i] = static_cast<float>(totals[i]);
+        }
+        return LanguageDetector::finalizeScores(scores, numFeatures);
+    }
+
+    // Contiguous view of the text, valid until the next edit. Closes the gap by
+    // moving it to the end.
+    std::string_view text() const {
+        moveGap(size());
+        return std::string_view(buffer.data(), size());
+    }
+
+    size_t size() const {
+        return buffer.size() - gapLength;
+    }
+
+private:
+    struct Segment {
+        size_t length;
+        LanguageDetector::TokenizerState state;  // tokenizer state at the segment start
+        PartialScore partial;
+    };
+
+    // findSplitPoint reads up to 7 bytes before the position it tests
+    static constexpr size_t SPLIT_LOOKBACK = 8;
+
+    // Moves the gap to start at text offset `pos`
+    void moveGap(size_t pos) const {
+        if (pos < gapBegin) {
+            std::memmove(&buffer[pos + gapLength], &buffer[pos], gapBegin - pos);
+        } else if (pos > gapBegin) {
+            std::memmove(&buffer[gapBegin], &buffer[gapBegin + gapLength], pos - gapBegin);
+        }
+        gapBegin = pos;
+    }
+
+    // Grows the buffer so the gap holds at least `length` bytes. The new gap is
+    // proportional to the text, so growing is amortized O(1) per inserted byte.
+    void reserveGap(size_t length) {
+        if (gapLength >= length) {
+            return;
+        }
+        size_t newGap = std::max(length, size() / 2 + 64);
+        size_t after = buffer.size() - gapBegin - gapLength;
+        buffer.resize(size() + newGap);
+        std::memmove(&buffer[buffer.size() - after], &buffer[gapBegin + gapLength], after);
+        gapLength = newGap;
+    }
+
+    // Text offsets at or after the gap index into this pointer directly
+    const char* tail() const {
+        return buffer.data() + gapLength;
+    }
+
+    // Fenwick tree over the segment lengths: index[i] is the sum of the lengths
+    // of segments [i - lowbit(i), i), 1-based
+    void rebuildIndex() {
+        index.assign(segments.size() + 1, 0);
+        for (size_t i = 1; i < index.size(); ++i) {
+            index[i] += segments[i - 1].length;
+            size_t parent = i + (i & (0 - i));
+            if (parent < index.size()) {
+                index[parent] += index[i];
+            }
+        }
+    }
+
+    // Adds `delta` (modulo 2^64, so shrinking works too) to the length of segment `s`
+    void addLength(size_t s, size_t delta) {
+        for (size_t i = s + 1; i < index.size(); i += i & (0 - i)) {
+            index[i] += delta;
+        }
+    }
+
+    // Index of the segment containing byte `offset` (the last one for the end of
+    // the text), with its start offset in `begin`
+    size_t findSegment(size_t offset, size_t& begin) const {
+        size_t n = segments.size();
+        size_t step = 1;
+        while (step * 2 <= n) {
+            step *= 2;
+        }
+        // Descend to the number of segments that end at or before `offset`
+        size_t s = 0;
+        begin = 0;
+        for (; step > 0; step /= 2) {
+            if (s + step <= n && begin + index[s + step] <= offset) {
+                s += step;
+                begin += index[s];
+            }
+        }
+        if (s == n) {
+            s = n - 1;
+            begin -= segments[s].length;
+        }
+        return s;
+    }
+
+    // Cuts text[begin, end) at the first split point after every segmentSize bytes
+    // and tokenizes the pieces, starting from `state`. Always returns at least one
+    // segment.
+    std::pmr::vector<Segment> splitRegion(size_t begin, size_t end, LanguageDetector::TokenizerState state) const {
+        std::pmr::vector<Segment> pieces(segments.get_allocator());
+        size_t current = begin;
+        LanguageDetector::TokenizerState currentState = state;
+
+        for (size_t target = begin + segmentSize; target < end; target += segmentSize) {
+            if (target <= current) {
+                continue;
+            }
+            size_t limit = std::min(target + segmentSize, end);
+            LanguageDetector::TokenizerState splitState;
+            size_t split = LanguageDetector::findSplitPoint(tail(), size(), target, limit, splitState);
+            if (split >= limit) {
+                continue;
+            }
+            pieces.push_back(tokenize(current, split, currentState));
+            current = split;
+            currentState = splitState;
+        }
+
+        pieces.push_back(tokenize(current, end, currentState));
+        return pieces;
+    }
+
+    Segment tokenize(size_t begin, size_t end, LanguageDetector::TokenizerState state) const {
+        Segment segment{end - begin, state, PartialScore()};
+        LanguageDetector::emitBuckets(tail() + begin, end - begin, state, [&](uint32_t bucket) {
+            segment.partial.numFeatures++;
+            LanguageDetector::addBucket(segment.partial.scores, bucket);
+        });
+        return segment;
+    }
+
+    void addPartial(const PartialScore& partial, double sign) {
+        for (size_t i = 0; i < totals.size(); ++i) {
+            totals[i] += sign * partial.scores[i];
+        }
+        if (sign > 0) {
+            numFeatures += partial.numFeatures;
+        } else {
+            numFeatures -= partial.numFeatures;
+        }
+    }
+
+    // The text is buffer[0, gapBegin) followed by buffer[gapBegin + gapLength, end).
+    // The gap only moves, so text() can be const.
+    mutable std::pmr::string buffer;
+    mutable size_t gapBegin;
+    size_t gapLength = 0;
+    size_t segmentSize;
+    std::pmr::vector<Segment> segments;
+    std::pmr::vector<size_t> index;
+    std::array<double, LanguageDetector::NUM_LANGUAGES> totals{};
+    uint64_t numFeatures = 0;
+};
+
+#endif // EDITABLE_DETECTOR_HPP
@@ -0,0 +1,355 @@
+// Low-rank factorization of a trained weights_*.hpp model.
+//
+// Computes a truncated SVD WEIGHTS (DIMENSION x L) ~= FACTOR_U (DIMENSION x r) * FACTOR_V (r x L),
+// reports accuracy against rank on the lingua test data and exports the chosen rank as a
+// header for language_detector_lowrank.hpp.
+//
+// For weights_4096.hpp this did not pay off: ranks 16 and 32 agree with the dense model
+// on only 17% and 32% of a 3520-line mixed-language corpus, and rank 64, which agrees on
+// 97.4%, still adds 64 floats per token plus a 64 x 75 projection per text, with FACTOR_U
+// (1 MB) barely smaller than WEIGHTS (1.2 MB). No factorized model is checked in.
+//
+// Build against any model, e.g.
+//   g++ -std=c++17 -O2 -DWHICHLANG_WEIGHTS='"weights_neg.hpp"' factorize.cpp -o factorize
+// Run:
+//   ./factorize [data_dir] [rank] [output_header]
+#include "language_detector.hpp"
+#include "language_codes.hpp"
+#include "tool_helpers.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <iomanip>
+
+constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+constexpr size_t DIMENSION = LanguageDetector::DIMENSION;
+
+// Eigen-decomposition of the symmetric L x L Gram matrix WEIGHTS^T * WEIGHTS by cyclic
+// Jacobi rotations. On return `eigenvalues` is sorted in descending order and column k
+// of `eigenvectors` (row-major, L x L) is the k-th right singular vector of WEIGHTS.
+void symmetricEigen(std::vector<double> a, std::vector<double>& eigenvalues,
+                    std::vector<double>& eigenvectors) {
+    const size_t n = NUM_LANGUAGES;
+    std::vector<double> v(n * n, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        v[i * n + i] = 1.0;
+    }
+
+    for (int sweep = 0; sweep < 100; ++sweep) {
+        double offDiagonal = 0.0;
+        for (size_t p = 0; p < n; ++p) {
+            for (size_t q = p + 1; q < n; ++q) {
+                offDiagonal += a[p * n + q] * a[p * n + q];
+            }
+        }
+        if (offDiagonal < 1e-22) {
+            break;
+        }
+
+        for (size_t p = 0; p < n; ++p) {
+            for (size_t q = p + 1; q < n; ++q) {
+                double apq = a[p * n + q];
+                if (std::abs(apq) < 1e-300) {
+                    continue;
+                }
+                double theta = (a[q * n + q] - a[p * n + p]) / (2.0 * apq);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+
+                for (size_t k = 0; k < n; ++k) {
+                    double akp = a[k * n + p];
+                    double akq = a[k * n + q];
+                    a[k * n + p] = c * akp - s * akq;
+                    a[k * n + q] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < n; ++k) {
+                    double apk = a[p * n + k];
+                    double aqk = a[q * n + k];
+                    a[p * n + k] = c * apk - s * aqk;
+                    a[q * n + k] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < n; ++k) {
+                    double vkp = v[k * n + p];
+                    double vkq = v[k * n + q];
+                    v[k * n + p] = c * vkp - s * vkq;
+                    v[k * n + q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(),
+              [&](size_t x, size_t y) { return a[x * n + x] > a[y * n + y]; });
+
+    eigenvalues.assign(n, 0.0);
+    eigenvectors.assign(n * n, 0.0);
+    for (size_t k = 0; k < n; ++k) {
+        eigenvalues[k] = std::max(0.0, a[order[k] * n + order[k]]);
+        for (size_t i = 0; i < n; ++i) {
+            eigenvectors[i * n + k] = v[i * n + order[k]];
+        }
+    }
+}
+
+void exportFactors(const std::string& outputFile, size_t rank, double retainedEnergy,
+                   const std::vector<float>& factorU, const std::vector<float>& factorV) {
+    std::ofstream file(outputFile);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + outputFile);
+    }
+
+    file << "// Auto-generated low-rank factorization of " << WHICHLANG_WEIGHTS << "\n";
+    file << "// WEIGHTS (" << DIMENSION << " x " << NUM_LANGUAGES << ") ~= FACTOR_U (" << DIMENSION
+         << " x " << rank << ") * FACTOR_V (" << rank << " x " << NUM_LANGUAGES << ")\n";
+    file << "// Retained energy: " << std::fixed << std::setprecision(2) << (100.0 * retainedEnergy) << "%\n";
+    file << "#pragma once\n#include <array>\n#include <string_view>\n\n";
+
+    file << "enum class Lang {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "    " << enumName(code) << ",  // " << code << "\n";
+    }
+    file << "};\n\n";
+
+    file << "constexpr std::string_view three_letter_code(Lang language) {\n    switch (language) {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "        case Lang::" << enumName(code) << ": return \"" << code << "\";\n";
+    }
+    file << "    }\n    return \"unknown\";\n}\n\n";
+
+    file << "constexpr std::array<Lang, " << NUM_LANGUAGES << "> LANGUAGES = {\n";
+    for (Lang lang : LANGUAGES) {
+        file << "    Lang::" << enumName(three_letter_code(lang)) << ",\n";
+    }
+    file << "};\n\n";
+
+    file << "constexpr size_t RANK = " << rank << ";\n\n";
+
+    file << "const std::array<float, " << factorU.size() << "> FACTOR_U = {\n";
+    writeArray(file, factorU);
+    file << "};\n\n";
+
+    file << "const std::array<float, " << factorV.size() << "> FACTOR_V = {\n";
+    writeArray(file, factorV);
+    file << "};\n\n";
+
+    file << "const float INTERCEPTS[" << NUM_LANGUAGES << "] = {\n";
+    writeArray(file, INTERCEPTS, NUM_LANGUAGES);
+    file << "};\n";
+}
+
+size_t argmax(const std::vector<double>& scores) {
+    return std::distance(scores.begin(), std::max_element(scores.begin(), scores.end()));
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDirectory = "../lingua/language-testdata/sentences"; // Default directory
+    size_t exportRank = 64;
+    std::string outputFile;
+
+    if (argc > 1) {
+        dataDirectory = argv[1];
+    }
+    if (argc > 2) {
+        exportRank = std::stoul(argv[2]);
+    }
+    if (argc > 3) {
+        outputFile = argv[3];
+    } else {
+        std::string model = WHICHLANG_WEIGHTS;
+        outputFile = model.substr(0, model.rfind('.')) + "_r" + std::to_string(exportRank) + ".hpp";
+    }
+    if (exportRank == 0 || exportRank > NUM_LANGUAGES) {
+        std::cerr << "Rank must be between 1 and " << NUM_LANGUAGES << "\n";
+        return 1;
+    }
+
+    std::cout << "Factorizing " << WHICHLANG_WEIGHTS << " (" << DIMENSION << " x " << NUM_LANGUAGES << ")\n";
+
+    // Adding the same constant to every language of a bucket row shifts all scores
+    // equally and never changes the argmax, so rows are centered before the SVD and
+    // that direction costs no rank.
+    std::vector<double> centered(DIMENSION * NUM_LANGUAGES);
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        const float* row = &WEIGHTS[bucket * NUM_LANGUAGES];
+        double mean = 0.0;
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            mean += row[i];
+        }
+        mean /= NUM_LANGUAGES;
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            centered[bucket * NUM_LANGUAGES + i] = row[i] - mean;
+        }
+    }
+
+    // Gram matrix G = W^T W, whose eigenvectors are the right singular vectors of W
+    std::vector<double> gram(NUM_LANGUAGES * NUM_LANGUAGES, 0.0);
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        const double* row = &centered[bucket * NUM_LANGUAGES];
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            for (size_t j = 0; j < NUM_LANGUAGES; ++j) {
+                gram[i * NUM_LANGUAGES + j] += row[i] * row[j];
+            }
+        }
+    }
+
+    std::vector<double> eigenvalues;
+    std::vector<double> rightVectors;
+    symmetricEigen(gram, eigenvalues, rightVectors);
+
+    double totalEnergy = 0.0;
+    for (double e : eigenvalues) {
+        totalEnergy += e;
+    }
+
+    // Projected rows P = W V: the first r columns are FACTOR_U for rank r
+    std::vector<double> projected(DIMENSION * NUM_LANGUAGES, 0.0);
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        const double* row = &centered[bucket * NUM_LANGUAGES];
+        for (size_t k = 0; k < NUM_LANGUAGES; ++k) {
+            double sum = 0.0;
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                sum += row[i] * rightVectors[i * NUM_LANGUAGES + k];
+            }
+            projected[bucket * NUM_LANGUAGES + k] = sum;
+        }
+    }
+
+    std::vector<size_t> ranks;
+    for (size_t r : {2, 4, 8, 12, 16, 24, 32, 48, 64}) {
+        if (r < NUM_LANGUAGES) {
+            ranks.push_back(r);
+        }
+    }
+    ranks.push_back(NUM_LANGUAGES);
+
+    std::cout << "\nRECONSTRUCTION\n";
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << std::setw(8) << "Rank" << std::setw(18) << "Retained energy"
+              << std::setw(18) << "Rel. Frob. err" << std::setw(16) << "Adds/token" << "\n";
+    std::cout << std::string(70, '-') << "\n";
+    std::vector<double> retained(NUM_LANGUAGES + 1, 0.0);
+    for (size_t k = 0; k < NUM_LANGUAGES; ++k) {
+        retained[k + 1] = retained[k] + eigenvalues[k];
+    }
+    for (size_t r : ranks) {
+        double fraction = totalEnergy > 0 ? retained[r] / totalEnergy : 1.0;
+        std::cout << std::setw(8) << r
+                  << std::setw(17) << std::fixed << std::setprecision(2) << (100.0 * fraction) << "%"
+                  << std::setw(18) << std::setprecision(4) << std::sqrt(std::max(0.0, 1.0 - fraction))
+                  << std::setw(16) << r << "\n";
+    }
+
+    // Accuracy against rank on the lingua data, and agreement with the full model
+    std::vector<int> rankCorrect(ranks.size(), 0);
+    std::vector<int> rankAgree(ranks.size(), 0);
+    int fullCorrect = 0;
+    int totalTests = 0;
+
+    if (std::filesystem::is_directory(dataDirectory)) {
+        std::cout << "\nEvaluating on " << dataDirectory << "...\n";
+
+        std::vector<double> full(NUM_LANGUAGES);
+        std::vector<double> latent(NUM_LANGUAGES);
+        std::vector<double> scores(NUM_LANGUAGES);
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+                continue;
+            }
+            std::string filename = entry.path().filename().string();
+            std::optional<Lang> language = LanguageCodes::fromCode(std::string_view(filename).substr(0, 2));
+            if (!language) {
+                continue;
+            }
+            size_t expected = LanguageCodes::index(*language);
+
+            for (const std::string& text : readWordsFromFile(entry.path().string())) {
+                std::fill(full.begin(), full.end(), 0.0);
+                std::fill(latent.begin(), latent.end(), 0.0);
+                uint32_t numFeatures = 0;
+
+                LanguageDetector::emitBuckets(text, [&](uint32_t bucket) {
+                    numFeatures++;
+                    for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                        full[i] += WEIGHTS[bucket * NUM_LANGUAGES + i];
+                        latent[i] += projected[bucket * NUM_LANGUAGES + i];
+                    }
+                });
+                if (numFeatures == 0) {
+                    continue;
+                }
+                double norm = 1.0 / std::sqrt(static_cast<double>(numFeatures));
+
+                for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                    scores[i] = full[i] * norm + INTERCEPTS[i];
+                }
+                size_t fullPrediction = argmax(scores);
+                fullCorrect += (fullPrediction == expected);
+
+                for (size_t r = 0; r < ranks.size(); ++r) {
+                    for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                        double sum = 0.0;
+                        for (size_t k = 0; k < ranks[r]; ++k) {
+                            sum += latent[k] * rightVectors[i * NUM_LANGUAGES + k];
+                        }
+                        scores[i] = sum * norm + INTERCEPTS[i];
+                    }
+                    size_t prediction = argmax(scores);
+                    rankCorrect[r] += (prediction == expected);
+                    rankAgree[r] += (prediction == fullPrediction);
+                }
+                totalTests++;
+            }
+        }
+
+        std::cout << "\nACCURACY VS RANK (" << totalTests << " texts)\n";
+        std::cout << std::string(70, '-') << "\n";
+        std::cout << std::setw(8) << "Rank" << std::setw(14) << "Accuracy"
+                  << std::setw(24) << "Agreement w/ full" << "\n";
+        std::cout << std::string(70, '-') << "\n";
+        for (size_t r = 0; r < ranks.size(); ++r) {
+            std::cout << std::setw(8) << ranks[r]
+                      << std::setw(13) << std::fixed << std::setprecision(2)
+                      << (totalTests > 0 ? 100.0 * rankCorrect[r] / totalTests : 0.0) << "%"
+                      << std::setw(23) << (totalTests > 0 ? 100.0 * rankAgree[r] / totalTests : 0.0) << "%\n";
+        }
+        std::cout << std::setw(8) << "full"
+                  << std::setw(13) << (totalTests > 0 ? 100.0 * fullCorrect / totalTests : 0.0) << "%\n";
+    } else {
+        std::cout << "\nData directory " << dataDirectory << " not found, skipping accuracy report\n";
+    }
+
+    // Export FACTOR_U = (W V)[:, :r] and FACTOR_V = V[:, :r]^T
+    std::vector<float> factorU(DIMENSION * exportRank);
+    std::vector<float> factorV(exportRank * NUM_LANGUAGES);
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        for (size_t k = 0; k < exportRank; ++k) {
+            factorU[bucket * exportRank + k] = static_cast<float>(projected[bucket * NUM_LANGUAGES + k]);
+        }
+    }
+    for (size_t k = 0; k < exportRank; ++k) {
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            factorV[k * NUM_LANGUAGES + i] = static_cast<float>(rightVectors[i * NUM_LANGUAGES + k]);
+        }
+    }
+
+    try {
+        exportFactors(outputFile, exportRank,
+                      totalEnergy > 0 ? retained[exportRank] / totalEnergy : 1.0, factorU, factorV);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "\nRank " << exportRank << " factors exported to " << outputFile << "\n";
+
+    return 0;
+}
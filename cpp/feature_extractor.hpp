@@ -0,0 +1,97 @@
+#ifndef FEATURE_EXTRACTOR_HPP
+#define FEATURE_EXTRACTOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "language_detector.hpp"
+
+// One hashed feature of a text: a bucket of the weight matrix and how many
+// times the text produced it
+struct FeatureCount {
+    uint32_t bucket;
+    uint32_t count;
+};
+
+// The hashed n-gram features detectLanguage computes, as a sparse vector other
+// stages (dedup, topic models) can reuse without tokenizing again, and that can
+// be cached and re-scored when the weights change. Features only depend on the
+// tokenizer, the hash seed and DIMENSION, so they stay valid for every model
+// sharing those, e.g. the ones of multi_model_detector.hpp.
+class FeatureExtractor {
+public:
+    static constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+    static constexpr size_t DIMENSION = LanguageDetector::DIMENSION;
+
+    // Replaces `out` with the features of `text`, sorted by bucket, one entry per
+    // distinct bucket. Returns the number of features, i.e. the sum of the counts.
+    // Tokens are counted in a DIMENSION-sized histogram on the stack, so time is
+    // linear in the text and `out` never holds more than DIMENSION entries. Only
+    // allocates, from the vector's allocator, if `out` has to grow.
+    template <typename Allocator>
+    static uint64_t extractFeatures(std::string_view text, std::vector<FeatureCount, Allocator>& out) {
+        out.clear();
+        uint32_t counts[DIMENSION] = {};
+        uint64_t numFeatures = 0;
+        LanguageDetector::TokenizerState state;
+        LanguageDetector::emitBuckets(text.data(), text.size(), state, [&](uint32_t bucket) {
+            if (counts[bucket]++ == 0) {
+                out.push_back({bucket, 0});
+            }
+            numFeatures++;
+        });
+
+        // Only the distinct buckets are sorted, at most DIMENSION of them
+        std::sort(out.begin(), out.end(), [](const FeatureCount& a, const FeatureCount& b) {
+            return a.bucket < b.bucket;
+        });
+        for (FeatureCount& feature : out) {
+            feature.count = counts[feature.bucket];
+        }
+        return numFeatures;
+    }
+
+    // Final scores of a feature vector under a model with the same DIMENSION and
+    // language order (by default the compiled-in one). Texts without features get
+    // all-zero scores. Equal to the scores of detectLanguage up to the rounding of
+    // the summation order.
+    static void scoreFeatures(const FeatureCount* features, size_t n, std::array<float, NUM_LANGUAGES>& scores,
+                              const float* weights = WEIGHTS.data(), const float* intercepts = INTERCEPTS) {
+        scores.fill(0.0f);
+        uint64_t numFeatures = 0;
+        for (size_t f = 0; f < n; ++f) {
+            const float* row = weights + features[f].bucket * NUM_LANGUAGES;
+            float count = static_cast<float>(features[f].count);
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                scores[i] += count * row[i];
+            }
+            numFeatures += features[f].count;
+        }
+        if (numFeatures == 0) {
+            return;
+        }
+
+        float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(numFeatures));
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            scores[i] = scores[i] * sqrtInvNumFeatures + intercepts[i];
+        }
+    }
+
+    // Best language of a feature vector, see above
+    template <typename Allocator>
+    static Lang scoreFeatures(const std::vector<FeatureCount, Allocator>& features,
+                              const float* weights = WEIGHTS.data(), const float* intercepts = INTERCEPTS) {
+        if (features.empty()) {
+            // Default to English
+            return Lang::En;
+        }
+        std::array<float, NUM_LANGUAGES> scores;
+        scoreFeatures(features.data(), features.size(), scores, weights, intercepts);
+        return LANGUAGES[std::distance(scores.begin(), std::max_element(scores.begin(), scores.end()))];
+    }
+};
+
+#endif // FEATURE_EXTRACTOR_HPP
@@ -0,0 +1,171 @@
+#ifndef LANGUAGE_CODES_HPP
+#define LANGUAGE_CODES_HPP
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+
+// Packing and hashing behind LanguageCodes::fromCode, kept in a class of their
+// own so LanguageCodes can build its tables with them at compile time
+struct LanguageCodeHash {
+    static constexpr uint32_t TABLE_BITS = 11;
+    static constexpr size_t TABLE_SIZE = size_t(1) << TABLE_BITS;
+
+    // Two or three ASCII letters, lowercased, one per byte; 0 for anything else
+    static constexpr uint32_t packCode(std::string_view code) {
+        if (code.size() < 2 || code.size() > 3) {
+            return 0;
+        }
+        uint32_t key = 0;
+        for (size_t i = 0; i < code.size(); ++i) {
+            uint32_t c = static_cast<unsigned char>(code[i]) | 0x20;
+            if (c < 'a' || c > 'z') {
+                return 0;
+            }
+            key |= c << (8 * i);
+        }
+        return key;
+    }
+
+    static constexpr uint32_t slot(uint32_t key, uint32_t multiplier) {
+        return (key * multiplier) >> (32 - TABLE_BITS);
+    }
+
+    struct CodePair {
+        std::string_view alpha2;
+        std::string_view alpha3;
+    };
+
+    // ISO 639-3 code of every ISO 639-1 code the trainers know about
+    static constexpr CodePair ISO_639_3[] = {
+        {"af", "afr"}, {"ar", "ara"}, {"az", "aze"}, {"be", "bel"}, {"bg", "bul"}, {"bn", "ben"},
+        {"bs", "bos"}, {"ca", "cat"}, {"cs", "ces"}, {"cy", "cym"}, {"da", "dan"}, {"de", "deu"},
+        {"el", "ell"}, {"en", "eng"}, {"eo", "epo"}, {"es", "spa"}, {"et", "est"}, {"eu", "eus"},
+        {"fa", "fas"}, {"fi", "fin"}, {"fr", "fra"}, {"ga", "gle"}, {"gu", "guj"}, {"he", "heb"},
+        {"hi", "hin"}, {"hr", "hrv"}, {"hu", "hun"}, {"hy", "hye"}, {"id", "ind"}, {"is", "isl"},
+        {"it", "ita"}, {"ja", "jpn"}, {"ka", "kat"}, {"kk", "kaz"}, {"ko", "kor"}, {"la", "lat"},
+        {"lg", "lug"}, {"lt", "lit"}, {"lv", "lav"}, {"mi", "mri"}, {"mk", "mkd"}, {"mn", "mon"},
+        {"mr", "mar"}, {"ms", "msa"}, {"nb", "nob"}, {"nl", "nld"}, {"nn", "nno"}, {"pa", "pan"},
+        {"pl", "pol"}, {"pt", "por"}, {"ro", "ron"}, {"ru", "rus"}, {"sk", "slk"}, {"sl", "slv"},
+        {"sn", "sna"}, {"so", "som"}, {"sq", "sqi"}, {"sr", "srp"}, {"st", "sot"}, {"sv", "swe"},
+        {"sw", "swa"}, {"ta", "tam"}, {"te", "tel"}, {"th", "tha"}, {"tl", "tgl"}, {"tn", "tsn"},
+        {"tr", "tur"}, {"ts", "tso"}, {"uk", "ukr"}, {"ur", "urd"}, {"vi", "vie"}, {"xh", "xho"},
+        {"yo", "yor"}, {"zh", "zho"}, {"zu", "zul"},
+    };
+};
+
+// Conversions between Lang and language codes, computed at compile time from
+// the Lang, LANGUAGES and three_letter_code of the model in use. Include it after
+// the detector (or weights) header of that model.
+//
+// Nothing allocates: codes are string_views of string literals, so their data()
+// is null-terminated and lives for the whole program. fromCode() accepts ISO
+// 639-1 ("de") and ISO 639-3 ("deu") codes in any case and costs a multiply, a
+// shift and one table load: every code of the model is packed into a 24-bit key,
+// and a multiplier found at compile time hashes all of them to distinct slots.
+class LanguageCodes {
+public:
+    static constexpr size_t NUM_LANGUAGES = std::tuple_size<decltype(LANGUAGES)>::value;
+
+    // ISO 639-1 and ISO 639-3 code of every language of the model, in LANGUAGES order
+    static constexpr std::array<std::string_view, NUM_LANGUAGES> CODES = [] {
+        std::array<std::string_view, NUM_LANGUAGES> codes{};
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            codes[i] = three_letter_code(LANGUAGES[i]);
+        }
+        return codes;
+    }();
+
+    static constexpr std::array<std::string_view, NUM_LANGUAGES> ISO_639_3_CODES = [] {
+        std::array<std::string_view, NUM_LANGUAGES> codes{};
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            for (const auto& [alpha2, alpha3] : LanguageCodeHash::ISO_639_3) {
+                if (alpha2 == CODES[i]) {
+                    codes[i] = alpha3;
+                }
+            }
+        }
+        return codes;
+    }();
+
+    // Position of a language in LANGUAGES
+    static constexpr size_t index(Lang language) {
+        return INDEX[static_cast<size_t>(language)];
+    }
+
+    // ISO 639-1 code, e.g. "de"
+    static constexpr std::string_view code(Lang language) {
+        return CODES[index(language)];
+    }
+
+    // ISO 639-3 code, e.g. "deu"
+    static constexpr std::string_view iso639_3(Lang language) {
+        return ISO_639_3_CODES[index(language)];
+    }
+
+    // Language of an ISO 639-1 or ISO 639-3 code, or nullopt if the model has none
+    static constexpr std::optional<Lang> fromCode(std::string_view code) {
+        uint32_t key = LanguageCodeHash::packCode(code);
+        uint32_t entry = TABLE[LanguageCodeHash::slot(key, MULTIPLIER)];
+        if (key == 0 || (entry & KEY_MASK) != key) {
+            return std::nullopt;
+        }
+        return LANGUAGES[(entry >> 24) - 1];
+    }
+
+private:
+    static constexpr uint32_t KEY_MASK = (1u << 24) - 1;
+    static constexpr size_t TABLE_SIZE = LanguageCodeHash::TABLE_SIZE;
+    static_assert(NUM_LANGUAGES < 255, "table entries hold the index in 8 bits");
+
+    static constexpr std::array<uint8_t, NUM_LANGUAGES> INDEX = [] {
+        std::array<uint8_t, NUM_LANGUAGES> index{};
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            index[static_cast<size_t>(LANGUAGES[i])] = static_cast<uint8_t>(i);
+        }
+        return index;
+    }();
+
+    // First multiplier of a fixed odd sequence that maps every code to its own slot
+    static constexpr uint32_t MULTIPLIER = [] {
+        std::array<uint16_t, TABLE_SIZE> usedInTrial{};
+        uint32_t multiplier = 0x9E3779B1u;
+        for (uint16_t trial = 1; trial != 0; ++trial, multiplier += 0x6A09E668u) {
+            bool perfect = true;
+            for (size_t i = 0; i < NUM_LANGUAGES && perfect; ++i) {
+                for (std::string_view code : {CODES[i], ISO_639_3_CODES[i]}) {
+                    uint32_t key = LanguageCodeHash::packCode(code);
+                    if (key == 0) {
+                        continue;
+                    }
+                    uint32_t s = LanguageCodeHash::slot(key, multiplier);
+                    perfect = perfect && usedInTrial[s] != trial;
+                    usedInTrial[s] = trial;
+                }
+            }
+            if (perfect) {
+                return multiplier;
+            }
+        }
+        return 0u;
+    }();
+    static_assert(MULTIPLIER != 0, "no perfect hash multiplier for the language codes");
+
+    // Key of the code in the low 24 bits, index in LANGUAGES + 1 in the high 8 bits
+    static constexpr std::array<uint32_t, TABLE_SIZE> TABLE = [] {
+        std::array<uint32_t, TABLE_SIZE> table{};
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            for (std::string_view code : {CODES[i], ISO_639_3_CODES[i]}) {
+                uint32_t key = LanguageCodeHash::packCode(code);
+                if (key != 0) {
+                    table[LanguageCodeHash::slot(key, MULTIPLIER)] = key | static_cast<uint32_t>(i + 1) << 24;
+                }
+            }
+        }
+        return table;
+    }();
+};
+
+#endif // LANGUAGE_CODES_HPP
@@ -1,18 +1,30 @@
 #ifndef LANGUAGE_DETECTOR_HPP
 #define LANGUAGE_DETECTOR_HPP
 
+#include <array>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <cmath>
-#include <functional>
 #include <cctype>
 #include <cstdint>
-#include "weights_4096.hpp"
+#include <cstring>
+#include <tuple>
+
+// Model tables to compile against. Any generated weights_*.hpp with the same
+// layout works, e.g. -DWHICHLANG_WEIGHTS='"weights_neg.hpp"'.
+#ifndef WHICHLANG_WEIGHTS
+#define WHICHLANG_WEIGHTS "weights_4096.hpp"
+#endif
+#include WHICHLANG_WEIGHTS
 
 class LanguageDetector {
+public:
+    static constexpr size_t NUM_LANGUAGES = std::tuple_size<decltype(LANGUAGES)>::value;
+    static constexpr size_t DIMENSION = std::tuple_size<decltype(WEIGHTS)>::value / NUM_LANGUAGES;
+
 private:
-    static constexpr size_t DIMENSION = 1 << 12;  // 4096
     static constexpr uint32_t BIGRAM_MASK = (1 << 16) - 1;
     static constexpr uint32_t TRIGRAM_MASK = (1 << 24) - 1;
     static constexpr uint32_t SEED = 3242157231u;
@@ -71,7 +83,7 @@ private:
     }
     
     static uint32_t classifyCodepoint(char32_t chr) {
-        static const std::vector<uint32_t> CLASSIFICATION_POINTS = {
+        static constexpr uint32_t CLASSIFICATION_POINTS[] = {
             160, 161, 171, 172, 173, 174, 187, 192, 196, 199, 200, 201, 202, 205,
             214, 220, 223, 224, 225, 226, 227, 228, 231, 232, 233, 234, 235, 236,
             237, 238, 239, 242, 243, 244, 245, 246, 249, 250, 251, 252, 333, 339,
@@ -80,9 +92,9 @@ private:
             JP_HALFWIDTH_KATAKANA_START, JP_HALFWIDTH_KATAKANA_END
         };
         
-        auto it = std::lower_bound(CLASSIFICATION_POINTS.begin(), CLASSIFICATION_POINTS.end(), 
+        auto it = std::lower_bound(std::begin(CLASSIFICATION_POINTS), std::end(CLASSIFICATION_POINTS),
                                    static_cast<uint32_t>(chr));
-        return static_cast<uint32_t>(std::distance(CLASSIFICATION_POINTS.begin(), it));
+        return static_cast<uint32_t>(std::distance(std::begin(CLASSIFICATION_POINTS), it));
     }
     
     static bool isAscii(char32_t c) {
@@ -100,128 +112,383 @@ private:
         return c;
     }
     
-    // Simple UTF-8 to UTF-32 conversion
-    static std::u32string utf8ToUtf32(const std::string& utf8) {
-        std::u32string result;
+    // Decodes the UTF-8 sequence starting at text[i] into `codepoint` and returns its
+    // length. Continuation bytes are not validated. Returns 0 if the sequence runs
+    // past `length`, and -1 for a stray continuation or invalid lead byte, which
+    // callers skip.
+    static int decodeUtf8(const char* text, size_t length, size_t i, char32_t& codepoint) {
+        unsigned char c = text[i];
+        
+        if (c <= 0x7F) {
+            // 1-byte character
+            codepoint = c;
+            return 1;
+        } else if ((c & 0xE0) == 0xC0) {
+            // 2-byte character
+            if (i + 1 >= length) return 0;
+            codepoint = ((c & 0x1F) << 6) | (text[i + 1] & 0x3F);
+            return 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            // 3-byte character
+            if (i + 2 >= length) return 0;
+            codepoint = ((c & 0x0F) << 12) | 
+                       ((text[i + 1] & 0x3F) << 6) | 
+                       (text[i + 2] & 0x3F);
+            return 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            // 4-byte character
+            if (i + 3 >= length) return 0;
+            codepoint = ((c & 0x07) << 18) | 
+                       ((text[i + 1] & 0x3F) << 12) | 
+                       ((text[i + 2] & 0x3F) << 6) | 
+                       (text[i + 3] & 0x3F);
+            return 4;
+        }
+        // Invalid UTF-8, skip
+        return -1;
+    }
+
+public:
+    // n-gram context carried from one code point to the next
+    struct TokenizerState {
+        uint32_t prev = static_cast<uint32_t>(' ');
+        int numPreviousAsciiChr = 1;
+    };
+
+private:
+    template <typename Listener>
+    static void emitCodepoint(char32_t chr, TokenizerState& state, Listener&& listener) {
+        uint32_t code = toLowerAscii(chr);
         
-        for (size_t i = 0; i < utf8.length();) {
-            char32_t codepoint = 0;
-            unsigned char c = utf8[i];
+        if (!isAscii(chr)) {
+            listener(FeatureToken(Feature::Unicode, static_cast<uint32_t>(chr)));
+            listener(FeatureToken(Feature::UnicodeClass, classifyCodepoint(chr)));
+            state.numPreviousAsciiChr = 0;
+            return;
+        }
+        
+        state.prev = (state.prev << 8) | code;
+        
+        switch (state.numPreviousAsciiChr) {
+            case 0:
+                state.numPreviousAsciiChr = 1;
+                break;
+            case 1:
+                listener(FeatureToken(Feature::AsciiNGram, state.prev & BIGRAM_MASK));
+                state.numPreviousAsciiChr = 2;
+                break;
+            case 2:
+                listener(FeatureToken(Feature::AsciiNGram, state.prev & BIGRAM_MASK));
+                listener(FeatureToken(Feature::AsciiNGram, state.prev & TRIGRAM_MASK));
+                state.numPreviousAsciiChr = 3;
+                break;
+            case 3:
+                listener(FeatureToken(Feature::AsciiNGram, state.prev & BIGRAM_MASK));
+                listener(FeatureToken(Feature::AsciiNGram, state.prev & TRIGRAM_MASK));
+                listener(FeatureToken(Feature::AsciiNGram, state.prev));
+                break;
+        }
+        
+        if (!isAlphaNumeric(chr)) {
+            state.prev = static_cast<uint32_t>(' ');
+        }
+    }
+    
+public:
+    // Calls fn(codepoint, offset) for every code point decoded from text[0, length),
+    // where offset is the byte position the code point starts at. Returns the
+    // number of bytes consumed: decoding stops at a UTF-8 sequence cut off by the
+    // end of the buffer, which is left for the caller.
+    template <typename Fn>
+    static size_t forEachCodepoint(const char* text, size_t length, Fn&& fn) {
+        size_t i = 0;
+        
+        while (i < length) {
+            char32_t chr = 0;
+            int sequenceLength = decodeUtf8(text, length, i, chr);
             
-            if (c <= 0x7F) {
-                // 1-byte character
-                codepoint = c;
-                i += 1;
-            } else if ((c & 0xE0) == 0xC0) {
-                // 2-byte character
-                if (i + 1 < utf8.length()) {
-                    codepoint = ((c & 0x1F) << 6) | (utf8[i + 1] & 0x3F);
-                    i += 2;
-                } else break;
-            } else if ((c & 0xF0) == 0xE0) {
-                // 3-byte character
-                if (i + 2 < utf8.length()) {
-                    codepoint = ((c & 0x0F) << 12) | 
-                               ((utf8[i + 1] & 0x3F) << 6) | 
-                               (utf8[i + 2] & 0x3F);
-                    i += 3;
-                } else break;
-            } else if ((c & 0xF8) == 0xF0) {
-                // 4-byte character
-                if (i + 3 < utf8.length()) {
-                    codepoint = ((c & 0x07) << 18) | 
-                               ((utf8[i + 1] & 0x3F) << 12) | 
-                               ((utf8[i + 2] & 0x3F) << 6) | 
-                               (utf8[i + 3] & 0x3F);
-                    i += 4;
-                } else break;
-            } else {
-                // Invalid UTF-8, skip
+            if (sequenceLength == 0) {
+                break;
+            }
+            if (sequenceLength < 0) {
                 i += 1;
                 continue;
             }
             
-            result.push_back(codepoint);
+            fn(chr, i);
+            i += sequenceLength;
         }
         
-        return result;
+        return i;
     }
     
-    static void emitTokens(const std::string& text, std::function<void(const FeatureToken&)> listener) {
-        std::u32string utf32Text = utf8ToUtf32(text);
-        
-        uint32_t prev = static_cast<uint32_t>(' ');
-        int numPreviousAsciiChr = 1;
+    // Whether any of the 4 UTF-16 units at `units` is in [0xD800, 0xDFFF]. Each
+    // lane is masked to its top 5 bits and compared with 0xD800 by looking for a
+    // zero lane: the borrow trick can only flag extra lanes above a zero one, so
+    // the answer for the whole word is exact.
+    static bool hasSurrogate(const char16_t* units) {
+        constexpr uint64_t LANE_ONES = 0x0001000100010001ull;
+        uint64_t word;
+        std::memcpy(&word, units, sizeof(word));
+        uint64_t diff = (word & (0xF800 * LANE_ONES)) ^ (0xD800 * LANE_ONES);
+        return ((diff - LANE_ONES) & ~diff & (0x8000 * LANE_ONES)) != 0;
+    }
+    
+    // Same as above for UTF-16 input (JVM and ICU strings), with offsets in code
+    // units. A surrogate pair is one code point; an unpaired surrogate is passed on
+    // as its own value, which is what the UTF-8 decoder yields for its 3-byte form.
+    template <typename Fn>
+    static void forEachCodepoint(std::u16string_view text, Fn&& fn) {
+        size_t i = 0;
         
-        for (char32_t chr : utf32Text) {
-            uint32_t code = toLowerAscii(chr);
-            
-            if (!isAscii(chr)) {
-                listener(FeatureToken(Feature::Unicode, static_cast<uint32_t>(chr)));
-                listener(FeatureToken(Feature::UnicodeClass, classifyCodepoint(chr)));
-                numPreviousAsciiChr = 0;
+        while (i < text.size()) {
+            // Four units at a time while none of them is a surrogate
+            if (i + 4 <= text.size() && !hasSurrogate(text.data() + i)) {
+                fn(static_cast<char32_t>(text[i]), i);
+                fn(static_cast<char32_t>(text[i + 1]), i + 1);
+                fn(static_cast<char32_t>(text[i + 2]), i + 2);
+                fn(static_cast<char32_t>(text[i + 3]), i + 3);
+                i += 4;
                 continue;
             }
             
-            prev = (prev << 8) | code;
+            char32_t chr = text[i];
             
-            switch (numPreviousAsciiChr) {
-                case 0:
-                    numPreviousAsciiChr = 1;
-                    break;
-                case 1:
-                    listener(FeatureToken(Feature::AsciiNGram, prev & BIGRAM_MASK));
-                    numPreviousAsciiChr = 2;
-                    break;
-                case 2:
-                    listener(FeatureToken(Feature::AsciiNGram, prev & BIGRAM_MASK));
-                    listener(FeatureToken(Feature::AsciiNGram, prev & TRIGRAM_MASK));
-                    numPreviousAsciiChr = 3;
-                    break;
-                case 3:
-                    listener(FeatureToken(Feature::AsciiNGram, prev & BIGRAM_MASK));
-                    listener(FeatureToken(Feature::AsciiNGram, prev & TRIGRAM_MASK));
-                    listener(FeatureToken(Feature::AsciiNGram, prev));
-                    break;
+            // Fast path: a unit outside the surrogate range is a code point on its own
+            if (chr < 0xD800 || chr > 0xDFFF) {
+                fn(chr, i);
+                i += 1;
+                continue;
             }
             
-            if (!isAlphaNumeric(chr)) {
-                prev = static_cast<uint32_t>(' ');
+            if (chr <= 0xDBFF && i + 1 < text.size() && text[i + 1] >= 0xDC00 && text[i + 1] <= 0xDFFF) {
+                fn(0x10000 + ((chr - 0xD800) << 10) + (text[i + 1] - 0xDC00), i);
+                i += 2;
+                continue;
             }
+            
+            fn(chr, i);
+            i += 1;
+        }
+    }
+    
+    // UTF-32 input needs no decoding
+    template <typename Fn>
+    static void forEachCodepoint(std::u32string_view text, Fn&& fn) {
+        for (size_t i = 0; i < text.size(); ++i) {
+            fn(text[i], i);
         }
     }
+    
+private:
+    // Tokenizes text[0, length) continuing from `state` and returns the number of
+    // bytes consumed, see forEachCodepoint
+    template <typename Listener>
+    static size_t emitTokens(const char* text, size_t length, TokenizerState& state, Listener&& listener) {
+        return forEachCodepoint(text, length, [&](char32_t chr, size_t) {
+            emitCodepoint(chr, state, listener);
+        });
+    }
+    
+    template <typename Listener>
+    static void emitTokens(std::string_view text, Listener&& listener) {
+        TokenizerState state;
+        emitTokens(text.data(), text.size(), state, listener);
+    }
 
 public:
-    static Lang detectLanguage(const std::string& text) {
-        const size_t numLanguages = LANGUAGES.size();
-        std::vector<float> scores(numLanguages, 0.0f);
-        uint32_t numFeatures = 0;
-        
+    // Calls listener(bucket) for every hashed feature of `text`, in the order
+    // detectLanguage accumulates them. Lets tools and alternative scorers reuse
+    // the exact tokenizer without going through the full weight matrix.
+    template <typename Listener>
+    static void emitBuckets(std::string_view text, Listener&& listener) {
         emitTokens(text, [&](const FeatureToken& token) {
-            numFeatures++;
-            uint32_t bucket = featureToHash(token) % DIMENSION;
-            size_t idx = bucket * numLanguages;
+            listener(featureToHash(token) % DIMENSION);
+        });
+    }
+
+    // Same as above for UTF-16 and UTF-32 text, decoded in place without
+    // transcoding. The buckets equal those of the UTF-8 encoding of the text.
+    template <typename Listener>
+    static void emitBuckets(std::u16string_view text, Listener&& listener) {
+        TokenizerState state;
+        forEachCodepoint(text, [&](char32_t chr, size_t) {
+            emitBuckets(chr, state, listener);
+        });
+    }
+
+    template <typename Listener>
+    static void emitBuckets(std::u32string_view text, Listener&& listener) {
+        TokenizerState state;
+        forEachCodepoint(text, [&](char32_t chr, size_t) {
+            emitBuckets(chr, state, listener);
+        });
+    }
+
+    // Buckets of the features completed by one code point, for callers that walk
+    // the code points themselves with forEachCodepoint
+    template <typename Listener>
+    static void emitBuckets(char32_t chr, TokenizerState& state, Listener&& listener) {
+        emitCodepoint(chr, state, [&](const FeatureToken& token) {
+            listener(featureToHash(token) % DIMENSION);
+        });
+    }
+
+    // Whether `chr` is part of a word; after any other code point the tokenizer
+    // restarts its n-grams at ' '
+    static bool isWordCodepoint(char32_t chr) {
+        // Same as isAlphaNumeric, without passing non-ASCII values to std::isalnum
+        return !isAscii(chr) || isAlphaNumeric(chr);
+    }
+
+    // Same as above, calling listener(bucket, offset) with the byte offset of the
+    // code point that completed each feature
+    template <typename Listener>
+    static void emitBucketsWithOffsets(std::string_view text, Listener&& listener) {
+        TokenizerState state;
+        forEachCodepoint(text.data(), text.size(), [&](char32_t chr, size_t offset) {
+            emitCodepoint(chr, state, [&](const FeatureToken& token) {
+                listener(featureToHash(token) % DIMENSION, offset);
+            });
+        });
+    }
+
+    // Same as above for one chunk of a longer text: tokenization continues from
+    // `state`, and the return value is the number of bytes consumed. A UTF-8
+    // sequence cut off at the end of the chunk is not consumed.
+    template <typename Listener>
+    static size_t emitBuckets(const char* text, size_t length, TokenizerState& state, Listener&& listener) {
+        return emitTokens(text, length, state, [&](const FeatureToken& token) {
+            listener(featureToHash(token) % DIMENSION);
+        });
+    }
+
+    // Byte length of the UTF-8 sequence introduced by `lead`, or 1 for bytes the
+    // decoder skips on their own
+    static size_t utf8SequenceLength(unsigned char lead) {
+        if ((lead & 0xE0) == 0xC0) return 2;
+        if ((lead & 0xF0) == 0xE0) return 3;
+        if ((lead & 0xF8) == 0xF0) return 4;
+        return 1;
+    }
+
+    // Finds the first position in [from, limit) where tokenization can restart
+    // without the text before it, and stores the tokenizer state for that position
+    // in `state`. Two kinds of positions qualify:
+    //  - after an ASCII non-alphanumeric character that ends a run of 6 ASCII
+    //    bytes: the decoder is in sync, prev was reset to ' ' and the n-gram
+    //    counter is saturated at 3;
+    //  - after a complete non-ASCII code point that no earlier lead byte can
+    //    swallow: the n-gram counter is 0, so prev is shifted out before any of
+    //    it is emitted again.
+    // Returns `limit` if there is no such position.
+    static size_t findSplitPoint(const char* text, size_t length, size_t from, size_t limit,
+                                 TokenizerState& state) {
+        limit = std::min(limit, length);
+        
+        for (size_t b = std::max<size_t>(from, 1); b < limit; ++b) {
+            unsigned char last = text[b - 1];
             
-            for (size_t i = 0; i < numLanguages; ++i) {
-                scores[i] += WEIGHTS[idx + i];
+            if (last <= 0x7F) {
+                if (b < 6 || isAlphaNumeric(last)) {
+                    continue;
+                }
+                bool asciiRun = true;
+                for (size_t j = b - 6; j < b - 1; ++j) {
+                    asciiRun = asciiRun && static_cast<unsigned char>(text[j]) <= 0x7F;
+                }
+                if (asciiRun) {
+                    state = TokenizerState{static_cast<uint32_t>(' '), 3};
+                    return b;
+                }
+                continue;
             }
-        });
+            
+            if ((static_cast<unsigned char>(text[b]) & 0xC0) == 0x80) {
+                continue;
+            }
+            for (size_t k = 2; k <= 4 && k <= b; ++k) {
+                size_t start = b - k;
+                if (utf8SequenceLength(static_cast<unsigned char>(text[start])) != k) {
+                    continue;
+                }
+                bool wellFormed = true;
+                for (size_t j = start + 1; j < b; ++j) {
+                    wellFormed = wellFormed && (static_cast<unsigned char>(text[j]) & 0xC0) == 0x80;
+                }
+                // A lead byte up to 3 bytes earlier could still claim `start` as a continuation
+                for (size_t j = start >= 3 ? start - 3 : 0; j < start; ++j) {
+                    wellFormed = wellFormed && j + utf8SequenceLength(static_cast<unsigned char>(text[j])) <= start;
+                }
+                char32_t chr = 0;
+                if (wellFormed && decodeUtf8(text, length, start, chr) == static_cast<int>(k) && !isAscii(chr)) {
+                    state = TokenizerState{static_cast<uint32_t>(' '), 0};
+                    return b;
+                }
+            }
+        }
+        
+        return limit;
+    }
+
+    // Adds the weight row of `bucket` to `scores`
+    static void addBucket(std::array<float, NUM_LANGUAGES>& scores, uint32_t bucket) {
+        size_t idx = bucket * NUM_LANGUAGES;
         
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            scores[i] += WEIGHTS[idx + i];
+        }
+    }
+
+    // Normalizes accumulated scores by the feature count (at least one) and adds
+    // the intercepts
+    static void normalizeScores(std::array<float, NUM_LANGUAGES>& scores, uint64_t numFeatures) {
+        float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(numFeatures));
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            scores[i] = scores[i] * sqrtInvNumFeatures + INTERCEPTS[i];
+        }
+    }
+
+    // Normalizes accumulated scores and returns the best language
+    static Lang finalizeScores(std::array<float, NUM_LANGUAGES> scores, uint64_t numFeatures) {
         if (numFeatures == 0) {
             // Default to English
             return Lang::En;
         }
         
-        float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(numFeatures));
-        for (size_t i = 0; i < numLanguages; ++i) {
-            scores[i] = scores[i] * sqrtInvNumFeatures + INTERCEPTS[i];
-        }
+        normalizeScores(scores, numFeatures);
         
         auto maxIt = std::max_element(scores.begin(), scores.end());
         size_t langId = std::distance(scores.begin(), maxIt);
         
         return LANGUAGES[langId];
     }
+
+    static Lang detectLanguage(std::string_view text) {
+        return scoreText(text);
+    }
+
+    static Lang detectLanguage(std::u16string_view text) {
+        return scoreText(text);
+    }
+
+    static Lang detectLanguage(std::u32string_view text) {
+        return scoreText(text);
+    }
+
+private:
+    template <typename Text>
+    static Lang scoreText(const Text& text) {
+        std::array<float, NUM_LANGUAGES> scores{};
+        uint32_t numFeatures = 0;
+        
+        emitBuckets(text, [&](uint32_t bucket) {
+            numFeatures++;
+            addBucket(scores, bucket);
+        });
+        
+        return finalizeScores(scores, numFeatures);
+    }
 };
 
 #endif // LANGUAGE_DETECTOR_HPP
@@ -1,11 +1,9 @@
 #ifndef LANGUAGE_DETECTOR_HPP
 #define LANGUAGE_DETECTOR_HPP
 
-#include <vector>
-#include <string>
+#include <string_view>
 #include <algorithm>
 #include <cmath>
-#include <functional>
 #include <cctype>
 #include <cstdint>
 #include "weights_64.hpp"
@@ -71,7 +69,7 @@ private:
     }
     
     static uint32_t classifyCodepoint(char32_t chr) {
-        static const std::vector<uint32_t> CLASSIFICATION_POINTS = {
+        static constexpr uint32_t CLASSIFICATION_POINTS[] = {
             160, 161, 171, 172, 173, 174, 187, 192, 196, 199, 200, 201, 202, 205,
             214, 220, 223, 224, 225, 226, 227, 228, 231, 232, 233, 234, 235, 236,
             237, 238, 239, 242, 243, 244, 245, 246, 249, 250, 251, 252, 333, 339,
@@ -80,9 +78,9 @@ private:
             JP_HALFWIDTH_KATAKANA_START, JP_HALFWIDTH_KATAKANA_END
         };
         
-        auto it = std::lower_bound(CLASSIFICATION_POINTS.begin(), CLASSIFICATION_POINTS.end(), 
+        auto it = std::lower_bound(std::begin(CLASSIFICATION_POINTS), std::end(CLASSIFICATION_POINTS),
                                    static_cast<uint32_t>(chr));
-        return static_cast<uint32_t>(std::distance(CLASSIFICATION_POINTS.begin(), it));
+        return static_cast<uint32_t>(std::distance(std::begin(CLASSIFICATION_POINTS), it));
     }
     
     static bool isAscii(char32_t c) {
@@ -100,67 +98,82 @@ private:
         return c;
     }
     
-    // Simple UTF-8 to UTF-32 conversion
-    static std::u32string utf8ToUtf32(const std::string& utf8) {
-        std::u32string result;
+    // Decodes the UTF-8 sequence starting at text[i] into `codepoint` and returns its
+    // length. Continuation bytes are not validated. Returns 0 if the sequence runs
+    // past `length`, and -1 for a stray continuation or invalid lead byte, which
+    // callers skip.
+    static int decodeUtf8(const char* text, size_t length, size_t i, char32_t& codepoint) {
+        unsigned char c = text[i];
         
-        for (size_t i = 0; i < utf8.length();) {
-            char32_t codepoint = 0;
-            unsigned char c = utf8[i];
+        if (c <= 0x7F) {
+            // 1-byte character
+            codepoint = c;
+            return 1;
+        } else if ((c & 0xE0) == 0xC0) {
+            // 2-byte character
+            if (i + 1 >= length) return 0;
+            codepoint = ((c & 0x1F) << 6) | (text[i + 1] & 0x3F);
+            return 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            // 3-byte character
+            if (i + 2 >= length) return 0;
+            codepoint = ((c & 0x0F) << 12) | 
+                       ((text[i + 1] & 0x3F) << 6) | 
+                       (text[i + 2] & 0x3F);
+            return 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            // 4-byte character
+            if (i + 3 >= length) return 0;
+            codepoint = ((c & 0x07) << 18) | 
+                       ((text[i + 1] & 0x3F) << 12) | 
+                       ((text[i + 2] & 0x3F) << 6) | 
+                       (text[i + 3] & 0x3F);
+            return 4;
+        }
+        // Invalid UTF-8, skip
+        return -1;
+    }
+    
+    // Calls fn(codepoint, offset) for every code point decoded from text[0, length),
+    // where offset is the byte position the code point starts at. Returns the
+    // number of bytes consumed: decoding stops at a UTF-8 sequence cut off by the
+    // end of the buffer, which is left for the caller.
+    template <typename Fn>
+    static size_t forEachCodepoint(const char* text, size_t length, Fn&& fn) {
+        size_t i = 0;
+        
+        while (i < length) {
+            char32_t chr = 0;
+            int sequenceLength = decodeUtf8(text, length, i, chr);
             
-            if (c <= 0x7F) {
-                // 1-byte character
-                codepoint = c;
-                i += 1;
-            } else if ((c & 0xE0) == 0xC0) {
-                // 2-byte character
-                if (i + 1 < utf8.length()) {
-                    codepoint = ((c & 0x1F) << 6) | (utf8[i + 1] & 0x3F);
-                    i += 2;
-                } else break;
-            } else if ((c & 0xF0) == 0xE0) {
-                // 3-byte character
-                if (i + 2 < utf8.length()) {
-                    codepoint = ((c & 0x0F) << 12) | 
-                               ((utf8[i + 1] & 0x3F) << 6) | 
-                               (utf8[i + 2] & 0x3F);
-                    i += 3;
-                } else break;
-            } else if ((c & 0xF8) == 0xF0) {
-                // 4-byte character
-                if (i + 3 < utf8.length()) {
-                    codepoint = ((c & 0x07) << 18) | 
-                               ((utf8[i + 1] & 0x3F) << 12) | 
-                               ((utf8[i + 2] & 0x3F) << 6) | 
-                               (utf8[i + 3] & 0x3F);
-                    i += 4;
-                } else break;
-            } else {
-                // Invalid UTF-8, skip
+            if (sequenceLength == 0) {
+                break;
+            }
+            if (sequenceLength < 0) {
                 i += 1;
                 continue;
             }
             
-            result.push_back(codepoint);
+            fn(chr, i);
+            i += sequenceLength;
         }
         
-        return result;
+        return i;
     }
     
-    static void emitTokens(const std::string& text, std::function<void(const FeatureToken&)> listener) {
-        std::u32string utf32Text = utf8ToUtf32(text);
-        
+    template <typename Listener>
+    static void emitTokens(std::string_view text, Listener&& listener) {
         uint32_t prev = static_cast<uint32_t>(' ');
         int numPreviousAsciiChr = 1;
         
-        for (char32_t chr : utf32Text) {
+        forEachCodepoint(text.data(), text.size(), [&](char32_t chr, size_t) {
             uint32_t code = toLowerAscii(chr);
             
             if (!isAscii(chr)) {
                 listener(FeatureToken(Feature::Unicode, static_cast<uint32_t>(chr)));
                 listener(FeatureToken(Feature::UnicodeClass, classifyCodepoint(chr)));
                 numPreviousAsciiChr = 0;
-                continue;
+                return;
             }
             
             prev = (prev << 8) | code;
@@ -188,22 +201,66 @@ private:
             if (!isAlphaNumeric(chr)) {
                 prev = static_cast<uint32_t>(' ');
             }
+        });
+    }
+
+    static constexpr size_t NUM_LANGUAGES = std::tuple_size<decltype(LANGUAGES)>::value;
+
+    // The whole 64-bucket model is only 64 x NUM_LANGUAGES floats. Instead of adding a
+    // weight row per token, tokens only bump a per-bucket histogram, and the model is
+    // applied once per document from a transposed copy (one 64-float column per
+    // language) that fits in a few vector registers.
+    struct TransposedWeights {
+        alignas(64) float column[NUM_LANGUAGES][DIMENSION];
+    };
+
+    static const TransposedWeights& transposedWeights() {
+        static const TransposedWeights transposed = [] {
+            TransposedWeights t{};
+            for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+                for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                    t.column[i][bucket] = WEIGHTS[bucket * NUM_LANGUAGES + i];
+                }
+            }
+            return t;
+        }();
+        return transposed;
+    }
+
+    // Counts are applied to the scores and cleared every FLUSH_INTERVAL features,
+    // so a count is at most 2^24 and converts to float exactly
+    static constexpr uint32_t FLUSH_INTERVAL = 1u << 24;
+
+    static void applyCounts(uint32_t (&bucketCounts)[DIMENSION], std::array<float, NUM_LANGUAGES>& scores) {
+        alignas(64) float counts[DIMENSION];
+        for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+            counts[bucket] = static_cast<float>(bucketCounts[bucket]);
+            bucketCounts[bucket] = 0;
+        }
+        
+        const TransposedWeights& weights = transposedWeights();
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            float sum = 0.0f;
+            for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+                sum += weights.column[i][bucket] * counts[bucket];
+            }
+            scores[i] += sum;
         }
     }
 
 public:
-    static Lang detectLanguage(const std::string& text) {
-        const size_t numLanguages = LANGUAGES.size();
-        std::vector<float> scores(numLanguages, 0.0f);
+    static Lang detectLanguage(std::string_view text) {
+        uint32_t bucketCounts[DIMENSION] = {};
+        std::array<float, NUM_LANGUAGES> scores{};
         uint32_t numFeatures = 0;
+        uint32_t untilFlush = FLUSH_INTERVAL;
         
         emitTokens(text, [&](const FeatureToken& token) {
             numFeatures++;
-            uint32_t bucket = featureToHash(token) % DIMENSION;
-            size_t idx = bucket * numLanguages;
-            
-            for (size_t i = 0; i < numLanguages; ++i) {
-                scores[i] += WEIGHTS[idx + i];
+            bucketCounts[featureToHash(token) % DIMENSION]++;
+            if (--untilFlush == 0) {
+                applyCounts(bucketCounts, scores);
+                untilFlush = FLUSH_INTERVAL;
             }
         });
         
@@ -211,9 +268,10 @@ public:
             // Default to English
             return Lang::En;
         }
+        applyCounts(bucketCounts, scores);
         
         float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(numFeatures));
-        for (size_t i = 0; i < numLanguages; ++i) {
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
             scores[i] = scores[i] * sqrtInvNumFeatures + INTERCEPTS[i];
         }
         
@@ -0,0 +1,281 @@
+#ifndef LANGUAGE_DETECTOR_HPP
+#define LANGUAGE_DETECTOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Freestanding model to compile against, a plain-array header exported by
+// quantize.cpp, e.g.
+//   g++ -std=c++17 -O2 -DWHICHLANG_WEIGHTS='"weights_4096.hpp"' quantize.cpp -o quantize
+//   ./quantize ../lingua/language-testdata/sentences int8 weights_4096_int8.hpp
+//   g++ ... -DWHICHLANG_FREESTANDING_MODEL='"weights_4096_int8.hpp"'
+#ifndef WHICHLANG_FREESTANDING_MODEL
+#error "Define WHICHLANG_FREESTANDING_MODEL to a header exported by quantize.cpp"
+#endif
+#include WHICHLANG_FREESTANDING_MODEL
+
+// LanguageDetector for freestanding and sandboxed builds, e.g.
+//   g++ -std=c++17 -O2 -ffreestanding -fno-exceptions -fno-rtti -c app.cpp
+// and linked without libstdc++. It uses no standard library containers, strings,
+// <functional>, <cctype>, <cmath> or exceptions, and never allocates: the model is
+// a set of constant arrays in .rodata and all scratch state is a fixed-size array
+// on the stack, so memory use is known at link time. The tokenizer is the one of
+// language_detector.hpp, and a float model gives the same results as it.
+//
+// With an int8 model the scores are summed as integers, one weight row per
+// feature, and scaled per language once per text.
+class LanguageDetector {
+public:
+    static constexpr size_t NUM_LANGUAGES = sizeof(LANGUAGES) / sizeof(LANGUAGES[0]);
+    static constexpr size_t DIMENSION = sizeof(WEIGHTS) / sizeof(WEIGHTS[0]) / NUM_LANGUAGES;
+
+    using Weight = std::remove_cv_t<std::remove_reference_t<decltype(WEIGHTS[0])>>;
+    using Accumulator = std::conditional_t<std::is_integral_v<Weight>, int32_t, float>;
+
+private:
+    static constexpr uint32_t BIGRAM_MASK = (1 << 16) - 1;
+    static constexpr uint32_t TRIGRAM_MASK = (1 << 24) - 1;
+    static constexpr uint32_t SEED = 3242157231u;
+
+    // Integer sums are moved into the float scores before they can overflow
+    static constexpr uint32_t FLUSH_INTERVAL = std::is_integral_v<Weight> ? (1u << 24) : 0xFFFFFFFFu;
+    static_assert(!std::is_integral_v<Weight> || sizeof(Weight) == 1, "integer models must be int8");
+
+    // Japanese and CJK Unicode ranges
+    static constexpr uint32_t JP_PUNCT_START = 0x3000;
+    static constexpr uint32_t JP_PUNCT_END = 0x303f;
+    static constexpr uint32_t JP_HIRAGANA_START = 0x3040;
+    static constexpr uint32_t JP_HIRAGANA_END = 0x309f;
+    static constexpr uint32_t JP_KATAKANA_START = 0x30a0;
+    static constexpr uint32_t JP_KATAKANA_END = 0x30ff;
+    static constexpr uint32_t CJK_KANJI_START = 0x4e00;
+    static constexpr uint32_t CJK_KANJI_END = 0x9faf;
+    static constexpr uint32_t JP_HALFWIDTH_KATAKANA_START = 0xff61;
+    static constexpr uint32_t JP_HALFWIDTH_KATAKANA_END = 0xff90;
+
+    static constexpr uint32_t CLASSIFICATION_POINTS[] = {
+        160, 161, 171, 172, 173, 174, 187, 192, 196, 199, 200, 201, 202, 205,
+        214, 220, 223, 224, 225, 226, 227, 228, 231, 232, 233, 234, 235, 236,
+        237, 238, 239, 242, 243, 244, 245, 246, 249, 250, 251, 252, 333, 339,
+        JP_PUNCT_START, JP_PUNCT_END, JP_HIRAGANA_START, JP_HIRAGANA_END,
+        JP_KATAKANA_START, JP_KATAKANA_END, CJK_KANJI_START, CJK_KANJI_END,
+        JP_HALFWIDTH_KATAKANA_START, JP_HALFWIDTH_KATAKANA_END
+    };
+    static constexpr size_t NUM_CLASSIFICATION_POINTS = sizeof(CLASSIFICATION_POINTS) / sizeof(uint32_t);
+
+    static uint32_t murmurhash2(uint32_t k, uint32_t seed) {
+        constexpr uint32_t M = 0x5bd1e995;
+        uint32_t h = seed;
+
+        k *= M;
+        k ^= k >> 24;
+        k *= M;
+        h *= M;
+        h ^= k;
+        h ^= h >> 13;
+        h *= M;
+        h ^= h >> 15;
+
+        return h;
+    }
+
+    // Index of the first classification point >= chr
+    static uint32_t classifyCodepoint(char32_t chr) {
+        size_t lo = 0;
+        size_t hi = NUM_CLASSIFICATION_POINTS;
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (CLASSIFICATION_POINTS[mid] < static_cast<uint32_t>(chr)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return static_cast<uint32_t>(lo);
+    }
+
+    static bool isAscii(char32_t c) {
+        return c <= 127;
+    }
+
+    // Same as std::isalnum in the "C" locale, plus every non-ASCII code point
+    static bool isAlphaNumeric(char32_t c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || !isAscii(c);
+    }
+
+    static char32_t toLowerAscii(char32_t c) {
+        return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+    }
+
+    // 1 / sqrtf(n) without libm: Newton's method in double from a power of two
+    // estimate, rounded once to float
+    static float inverseSqrt(uint32_t n) {
+        double value = static_cast<float>(n);
+        double x = 1.0;
+        for (uint32_t m = n; m >= 4; m >>= 2) {
+            x *= 2.0;
+        }
+        for (int i = 0; i < 8; ++i) {
+            x = 0.5 * (x + value / x);
+        }
+        return 1.0f / static_cast<float>(x);
+    }
+
+    static void addRow(Accumulator* sums, uint32_t bucket) {
+        const Weight* row = WEIGHTS + bucket * NUM_LANGUAGES;
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            sums[i] += row[i];
+        }
+    }
+
+public:
+    // n-gram context carried from one code point to the next
+    struct TokenizerState {
+        uint32_t prev = static_cast<uint32_t>(' ');
+        int numPreviousAsciiChr = 1;
+    };
+
+    // Calls listener(bucket) for every hashed feature of text[0, length), continuing
+    // from `state`. Returns the number of bytes consumed: a UTF-8 sequence cut off
+    // by the end of the buffer is left for the next call.
+    template <typename Listener>
+    static size_t emitBuckets(const char* text, size_t length, TokenizerState& state, Listener&& listener) {
+        size_t i = 0;
+
+        while (i < length) {
+            unsigned char c = text[i];
+            char32_t chr;
+            size_t sequenceLength;
+
+            if (c <= 0x7F) {
+                chr = c;
+                sequenceLength = 1;
+            } else if ((c & 0xE0) == 0xC0) {
+                if (i + 1 >= length) break;
+                chr = ((c & 0x1F) << 6) | (text[i + 1] & 0x3F);
+                sequenceLength = 2;
+            } else if ((c & 0xF0) == 0xE0) {
+                if (i + 2 >= length) break;
+                chr = ((c & 0x0F) << 12) | ((text[i + 1] & 0x3F) << 6) | (text[i + 2] & 0x3F);
+                sequenceLength = 3;
+            } else if ((c & 0xF8) == 0xF0) {
+                if (i + 3 >= length) break;
+                chr = ((c & 0x07) << 18) | ((text[i + 1] & 0x3F) << 12) | ((text[i + 2] & 0x3F) << 6)
+                    | (text[i + 3] & 0x3F);
+                sequenceLength = 4;
+            } else {
+                // Invalid UTF-8, skip
+                i += 1;
+                continue;
+            }
+
+            emitBuckets(chr, state, listener);
+            i += sequenceLength;
+        }
+
+        return i;
+    }
+
+    // Buckets of the features completed by one code point
+    template <typename Listener>
+    static void emitBuckets(char32_t chr, TokenizerState& state, Listener&& listener) {
+        if (!isAscii(chr)) {
+            listener(murmurhash2(static_cast<uint32_t>(chr) / 128, SEED ^ 2) % DIMENSION);
+            listener(murmurhash2(classifyCodepoint(chr), SEED ^ 4) % DIMENSION);
+            state.numPreviousAsciiChr = 0;
+            return;
+        }
+
+        state.prev = (state.prev << 8) | toLowerAscii(chr);
+
+        switch (state.numPreviousAsciiChr) {
+            case 0:
+                state.numPreviousAsciiChr = 1;
+                break;
+            case 1:
+                listener(murmurhash2(state.prev & BIGRAM_MASK, SEED) % DIMENSION);
+                state.numPreviousAsciiChr = 2;
+                break;
+            case 2:
+                listener(murmurhash2(state.prev & BIGRAM_MASK, SEED) % DIMENSION);
+                listener(murmurhash2(state.prev & TRIGRAM_MASK, SEED) % DIMENSION);
+                state.numPreviousAsciiChr = 3;
+                break;
+            case 3:
+                listener(murmurhash2(state.prev & BIGRAM_MASK, SEED) % DIMENSION);
+                listener(murmurhash2(state.prev & TRIGRAM_MASK, SEED) % DIMENSION);
+                listener(murmurhash2(state.prev, SEED) % DIMENSION);
+                break;
+        }
+
+        if (!isAlphaNumeric(chr)) {
+            state.prev = static_cast<uint32_t>(' ');
+        }
+    }
+
+    // Final scores of every language, in LANGUAGES order. Returns the number of
+    // features; without any, the scores are left at zero.
+    static uint32_t scoreText(const char* text, size_t length, float (&scores)[NUM_LANGUAGES]) {
+        Accumulator sums[NUM_LANGUAGES] = {};
+        uint32_t numFeatures = 0;
+        uint32_t untilFlush = FLUSH_INTERVAL;
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            scores[i] = 0.0f;
+        }
+
+        auto flush = [&]() {
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                scores[i] += static_cast<float>(sums[i]);
+                sums[i] = 0;
+            }
+            untilFlush = FLUSH_INTERVAL;
+        };
+
+        TokenizerState state;
+        emitBuckets(text, length, state, [&](uint32_t bucket) {
+            numFeatures++;
+            addRow(sums, bucket);
+            if (--untilFlush == 0) {
+                flush();
+            }
+        });
+        if (numFeatures == 0) {
+            return 0;
+        }
+        flush();
+
+        float sqrtInvNumFeatures = inverseSqrt(numFeatures);
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            scores[i] = scores[i] * WEIGHT_SCALES[i] * sqrtInvNumFeatures + INTERCEPTS[i];
+        }
+        return numFeatures;
+    }
+
+    static Lang detectLanguage(const char* text, size_t length) {
+        float scores[NUM_LANGUAGES];
+        if (scoreText(text, length, scores) == 0) {
+            // Default to English
+            return Lang::En;
+        }
+
+        size_t langId = 0;
+        for (size_t i = 1; i < NUM_LANGUAGES; ++i) {
+            if (scores[i] > scores[langId]) {
+                langId = i;
+            }
+        }
+        return LANGUAGES[langId];
+    }
+
+    // Nul-terminated text
+    static Lang detectLanguage(const char* text) {
+        size_t length = 0;
+        while (text[length] != '\0') {
+            length++;
+        }
+        return detectLanguage(text, length);
+    }
+};
+
+#endif // LANGUAGE_DETECTOR_HPP
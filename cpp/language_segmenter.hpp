@@ -0,0 +1,177 @@
+#ifndef LANGUAGE_SEGMENTER_HPP
+#define LANGUAGE_SEGMENTER_HPP
+
+#include <array>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "language_detector.hpp"
+
+struct LanguageSpan {
+    size_t begin;  // byte offsets into the text, [begin, end)
+    size_t end;
+    Lang language;
+};
+
+struct SegmenterConfig {
+    size_t windowSize = 256;     // bytes of context scored for each position
+    size_t stride = 32;          // resolution of span boundaries, in bytes
+    size_t minSpanLength = 128;  // shorter spans are absorbed by a neighbour
+};
+
+// Splits a mixed-language text (quoted replies, bilingual pages, code switching)
+// into (byte range, language) spans.
+//
+// The text is tokenized once. Token contributions are summed per stride-sized
+// block and the blocks slide through a running window sum, so moving the window
+// by one block is one addition and one subtraction per language, and the whole
+// segmentation is linear in the text. Each block is labelled with the language
+// of the window centred on it; runs of equal labels become spans. The spans and
+// all scratch buffers are allocated from `memory`; besides the spans and one
+// label per block, scratch memory is about windowBlocks * NUM_LANGUAGES doubles.
+class LanguageSegmenter {
+public:
+    static std::pmr::vector<LanguageSpan> segment(std::string_view text, const SegmenterConfig& config = {},
+                                                  std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        constexpr size_t numLanguages = LanguageDetector::NUM_LANGUAGES;
+        std::pmr::vector<LanguageSpan> spans(memory);
+        if (text.empty()) {
+            return spans;
+        }
+
+        size_t stride = std::max<size_t>(config.stride, 1);
+        size_t numBlocks = (text.size() + stride - 1) / stride;
+        size_t windowBlocks = std::max<size_t>(config.windowSize / stride, 1);
+
+        // The window of block b is blocks [lo, hi) with hi = b + windowBlocks -
+        // windowBlocks / 2, both clamped to the text. Blocks are pushed into a
+        // running window sum as the tokenizer leaves them, so only the last
+        // windowBlocks block sums are kept, in a ring: scratch memory is bounded by
+        // the window, not the text, apart from one label per block.
+        size_t ahead = windowBlocks - windowBlocks / 2;
+        std::pmr::vector<double> ringScores(windowBlocks * numLanguages, 0.0, memory);
+        std::pmr::vector<uint64_t> ringCounts(windowBlocks, 0, memory);
+        std::array<double, numLanguages> blockScores{};
+        std::array<double, numLanguages> windowScores{};
+        uint64_t blockCount = 0;
+        uint64_t windowCount = 0;
+        size_t numPushed = 0;
+
+        std::pmr::vector<Lang> labels(numBlocks, Lang{}, memory);
+        std::pmr::vector<bool> hasFeatures(numBlocks, false, memory);
+        std::array<float, numLanguages> scores;
+        auto label = [&](size_t block) {
+            hasFeatures[block] = windowCount > 0;
+            for (size_t i = 0; i < numLanguages; ++i) {
+                scores[i] = static_cast<float>(windowScores[i]);
+            }
+            labels[block] = LanguageDetector::finalizeScores(scores, windowCount);
+        };
+
+        // Moves the current block into the window, dropping the block that falls
+        // out of it, and labels every block whose window is now complete
+        auto pushBlock = [&]() {
+            size_t slot = numPushed % windowBlocks;
+            double* ring = &ringScores[slot * numLanguages];
+            for (size_t i = 0; i < numLanguages; ++i) {
+                windowScores[i] += blockScores[i] - ring[i];
+                ring[i] = blockScores[i];
+            }
+            windowCount += blockCount - ringCounts[slot];
+            ringCounts[slot] = blockCount;
+            blockScores.fill(0.0);
+            blockCount = 0;
+            numPushed++;
+
+            if (numPushed < numBlocks) {
+                if (numPushed >= ahead) {
+                    label(numPushed - ahead);
+                }
+                return;
+            }
+            for (size_t block = numBlocks > ahead ? numBlocks - ahead : 0; block < numBlocks; ++block) {
+                label(block);
+            }
+        };
+
+        LanguageDetector::emitBucketsWithOffsets(text, [&](uint32_t bucket, size_t offset) {
+            while (numPushed < offset / stride) {
+                pushBlock();
+            }
+            const float* row = &WEIGHTS[bucket * numLanguages];
+            for (size_t i = 0; i < numLanguages; ++i) {
+                blockScores[i] += row[i];
+            }
+            blockCount++;
+        });
+        while (numPushed < numBlocks) {
+            pushBlock();
+        }
+
+        // Windows without any feature (long runs of digits or punctuation) take the
+        // label of the closest preceding window that had some
+        size_t firstLabelled = 0;
+        while (firstLabelled < numBlocks && !hasFeatures[firstLabelled]) {
+            firstLabelled++;
+        }
+        if (firstLabelled == numBlocks) {
+            spans.push_back({0, text.size(), LanguageDetector::finalizeScores(scores, 0)});
+            return spans;
+        }
+        for (size_t block = 0; block < numBlocks; ++block) {
+            if (block < firstLabelled) {
+                labels[block] = labels[firstLabelled];
+            } else if (!hasFeatures[block]) {
+                labels[block] = labels[block - 1];
+            }
+        }
+
+        for (size_t block = 0; block < numBlocks; ++block) {
+            size_t begin = codepointBoundary(text, block * stride);
+            if (!spans.empty() && spans.back().language == labels[block]) {
+                continue;
+            }
+            if (!spans.empty()) {
+                spans.back().end = begin;
+            }
+            spans.push_back({begin, text.size(), labels[block]});
+        }
+
+        absorbShortSpans(spans, config.minSpanLength);
+        return spans;
+    }
+
+private:
+    // First code point start at or after `offset`, so spans never cut a UTF-8 sequence
+    static size_t codepointBoundary(std::string_view text, size_t offset) {
+        while (offset < text.size() && (static_cast<unsigned char>(text[offset]) & 0xC0) == 0x80) {
+            offset++;
+        }
+        return offset;
+    }
+
+    // Merges every span shorter than minSpanLength into the preceding kept span
+    // (or the following one at the start of the text), then joins neighbours that
+    // ended up with the same language. Works in place.
+    static void absorbShortSpans(std::pmr::vector<LanguageSpan>& spans, size_t minSpanLength) {
+        size_t numKept = 0;
+        for (const LanguageSpan& span : spans) {
+            LanguageSpan* last = numKept > 0 ? &spans[numKept - 1] : nullptr;
+            bool isShort = span.end - span.begin < minSpanLength;
+            if (last && (isShort || last->language == span.language)) {
+                last->end = span.end;
+                continue;
+            }
+            if (last && last->end - last->begin < minSpanLength) {
+                // A short leading span takes the language of the first long one
+                last->end = span.end;
+                last->language = span.language;
+                continue;
+            }
+            spans[numKept++] = span;
+        }
+        spans.resize(numKept);
+    }
+};
+
+#endif // LANGUAGE_SEGMENTER_HPP
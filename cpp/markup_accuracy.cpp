@@ -0,0 +1,164 @@
+// Accuracy and throughput of MarkupStripper on markup-wrapped sentences.
+//
+// Wraps every lingua test sentence in HTML (a paragraph with a link, an entity and a
+// tracking URL) and in Markdown, then compares detectLanguage on the plain sentence,
+// detectLanguage on the wrapped text and MarkupStripper::detectLanguage on the
+// wrapped text. Throughput is measured over all wrapped texts.
+//
+// Before that, it checks that stripping stays linear on inputs that open many
+// tags and never close them, and fails if 8x the input takes far more than 8x
+// the time.
+//
+// Build:
+//   g++ -std=c++17 -O2 markup_accuracy.cpp -o markup_accuracy
+// Run:
+//   ./markup_accuracy [data_dir]
+#include "markup_stripper.hpp"
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <iomanip>
+
+// Helper function to trim whitespace from a string
+std::string trim(const std::string& str) {
+    size_t start = str.find_first_not_of(" \t\n\r");
+    if (start == std::string::npos) return "";
+    size_t end = str.find_last_not_of(" \t\n\r");
+    return str.substr(start, end - start + 1);
+}
+
+std::vector<std::string> readWordsFromFile(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filepath);
+    }
+
+    std::vector<std::string> words;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string word = trim(line);
+        if (!word.empty()) {
+            words.push_back(word);
+        }
+    }
+
+    return words;
+}
+
+std::string wrapHtml(const std::string& sentence) {
+    return "<div class=\"post-body\" data-id=\"8812\"><p style=\"margin:0\">" + sentence
+           + " <a href=\"https://www.example.com/share?utm_source=feed&amp;utm_medium=rss\">&raquo;</a>"
+           + "</p><span class=\"meta\">contact: editor@example.com</span></div>";
+}
+
+std::string wrapMarkdown(const std::string& sentence) {
+    return "## " + sentence + "\n\n*Source:* [link](https://www.example.com/articles/2024/08/story) `id=8812`\n";
+}
+
+// Seconds MarkupStripper takes on `pattern` repeated to `length` bytes
+double stripSeconds(const std::string& pattern, size_t length) {
+    std::string text;
+    while (text.size() < length) {
+        text += pattern;
+    }
+    auto start = std::chrono::steady_clock::now();
+    volatile Lang language = MarkupStripper::detectLanguage(text);
+    (void)language;
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool checkLinearTime() {
+    const char* const PATTERNS[] = {"<a ", "a <b && c <d ", "<a href=\"x> ", "<p title='it> "};
+    bool linear = true;
+    for (const char* pattern : PATTERNS) {
+        double small = stripSeconds(pattern, 1 << 17);
+        double large = stripSeconds(pattern, 1 << 20);
+        double ratio = large / small;
+        std::cout << std::setw(24) << ("\"" + std::string(pattern) + "\"...") << std::fixed << std::setprecision(1)
+                  << std::setw(8) << ratio << "x time for 8x input\n";
+        linear = linear && ratio < 32.0;
+    }
+    return linear;
+}
+
+struct Sample {
+    std::string expectedLang;
+    std::string plain;
+    std::string wrapped;
+};
+
+int main(int argc, char* argv[]) {
+    std::string dataDirectory = "../lingua/language-testdata/sentences"; // Default directory
+
+    if (argc > 1) {
+        dataDirectory = argv[1];
+    }
+
+    if (!checkLinearTime()) {
+        std::cerr << "Error: stripping is not linear in the input length\n";
+        return 1;
+    }
+    std::cout << "\n";
+
+    std::vector<Sample> samples;
+    try {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+                continue;
+            }
+            std::string expectedLang = entry.path().filename().string().substr(0, 2);
+            for (const std::string& sentence : readWordsFromFile(entry.path().string())) {
+                samples.push_back({expectedLang, sentence, wrapHtml(sentence)});
+                samples.push_back({expectedLang, sentence, wrapMarkdown(sentence)});
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        std::cerr << "Make sure the data directory exists and contains .txt files\n";
+        return 1;
+    }
+
+    if (samples.empty()) {
+        std::cerr << "No sentences found in " << dataDirectory << "\n";
+        return 1;
+    }
+
+    int plainCorrect = 0;
+    int wrappedCorrect = 0;
+    int strippedCorrect = 0;
+    size_t wrappedBytes = 0;
+    double rawSeconds = 0.0;
+    double strippedSeconds = 0.0;
+
+    for (const Sample& sample : samples) {
+        plainCorrect += three_letter_code(LanguageDetector::detectLanguage(sample.plain)) == sample.expectedLang;
+
+        auto start = std::chrono::steady_clock::now();
+        Lang raw = LanguageDetector::detectLanguage(sample.wrapped);
+        auto middle = std::chrono::steady_clock::now();
+        Lang stripped = MarkupStripper::detectLanguage(sample.wrapped);
+        auto end = std::chrono::steady_clock::now();
+
+        rawSeconds += std::chrono::duration<double>(middle - start).count();
+        strippedSeconds += std::chrono::duration<double>(end - middle).count();
+        wrappedBytes += sample.wrapped.size();
+        wrappedCorrect += three_letter_code(raw) == sample.expectedLang;
+        strippedCorrect += three_letter_code(stripped) == sample.expectedLang;
+    }
+
+    double total = static_cast<double>(samples.size());
+    std::cout << samples.size() << " wrapped samples (HTML and Markdown)\n\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(28) << "" << std::setw(12) << "Accuracy" << std::setw(14) << "MB/s" << "\n";
+    std::cout << std::string(54, '-') << "\n";
+    std::cout << std::setw(28) << "plain sentence" << std::setw(11) << 100.0 * plainCorrect / total << "%\n";
+    std::cout << std::setw(28) << "wrapped, detectLanguage" << std::setw(11) << 100.0 * wrappedCorrect / total << "%"
+              << std::setw(14) << wrappedBytes / rawSeconds / 1e6 << "\n";
+    std::cout << std::setw(28) << "wrapped, MarkupStripper" << std::setw(11) << 100.0 * strippedCorrect / total << "%"
+              << std::setw(14) << wrappedBytes / strippedSeconds / 1e6 << "\n";
+
+    return 0;
+}
@@ -0,0 +1,397 @@
+#ifndef MARKUP_STRIPPER_HPP
+#define MARKUP_STRIPPER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include "language_detector.hpp"
+
+// Optional preprocessing stage for HTML and Markdown input. The text is scanned
+// for tags (script and style bodies and comments included), entities, URLs,
+// email addresses and Markdown syntax (link targets, code spans and fences,
+// emphasis and heading markers). Only the visible runs between them are handed
+// to the tokenizer, straight from the input buffer, with a single tokenizer
+// state carried across runs, so no stripped copy of the text is built.
+//
+// Removed markup acts as a word break, except inline tags such as <b> or <a>,
+// which join the text around them the way a browser renders it. Numeric entities
+// and the named ones in NAMED_ENTITIES are tokenized as the character they stand
+// for; other entities are left as literal text.
+class MarkupStripper {
+public:
+    // Calls listener(bucket) for every feature of the visible text
+    template <typename Listener>
+    static void emitVisibleBuckets(const char* text, size_t length, Listener&& listener) {
+        LanguageDetector::TokenizerState state;
+        bool lastWasSpace = true;  // the tokenizer starts as if after a space
+        size_t runStart = 0;
+        size_t i = 0;
+
+        auto flush = [&](size_t end) {
+            if (end > runStart) {
+                LanguageDetector::emitBuckets(text + runStart, end - runStart, state, listener);
+                lastWasSpace = isSpace(text[end - 1]);
+            }
+        };
+        auto emit = [&](char32_t chr) {
+            if (chr == U' ' && lastWasSpace) {
+                return;
+            }
+            LanguageDetector::emitBuckets(chr, state, listener);
+            lastWasSpace = chr == U' ';
+        };
+
+        while (true) {
+            // Character-class scan to the next byte that can start or end markup
+            while (i < length && !SPECIAL[static_cast<unsigned char>(text[i])]) {
+                i++;
+            }
+            if (i >= length) {
+                break;
+            }
+
+            Markup markup = recognize(text, length, i, runStart);
+            if (markup.end == 0) {
+                i++;
+                continue;
+            }
+            flush(markup.begin);
+            if (markup.replacement != 0) {
+                emit(markup.replacement);
+            }
+            runStart = i = markup.end;
+        }
+        flush(length);
+    }
+
+    template <typename Listener>
+    static void emitVisibleBuckets(std::string_view text, Listener&& listener) {
+        emitVisibleBuckets(text.data(), text.size(), listener);
+    }
+
+    static Lang detectLanguage(std::string_view text) {
+        std::array<float, LanguageDetector::NUM_LANGUAGES> scores{};
+        uint32_t numFeatures = 0;
+
+        emitVisibleBuckets(text, [&](uint32_t bucket) {
+            numFeatures++;
+            LanguageDetector::addBucket(scores, bucket);
+        });
+
+        return LanguageDetector::finalizeScores(scores, numFeatures);
+    }
+
+private:
+    // Bytes [begin, end) are markup, tokenized as `replacement` (0 for nothing).
+    // end == 0 means no markup starts here.
+    struct Markup {
+        size_t begin;
+        size_t end;
+        char32_t replacement;
+    };
+
+    static constexpr size_t MAX_ENTITY_LENGTH = 10;
+    static constexpr size_t MAX_LINK_TARGET_LENGTH = 2048;
+    static constexpr size_t MAX_TAG_LENGTH = 2048;
+
+    struct NamedEntity {
+        std::string_view name;
+        char32_t value;
+    };
+
+    // The markup characters plus the HTML 4 Latin-1 letters (U+00C0-U+00FF) and
+    // the Latin Extended-A ones languages in the model use. Sorted by name, case
+    // sensitive, for binary search.
+    static constexpr NamedEntity NAMED_ENTITIES[] = {
+        {"AElig", 0xC6}, {"AMP", U'&'}, {"Aacute", 0xC1}, {"Acirc", 0xC2}, {"Agrave", 0xC0}, {"Aring", 0xC5},
+        {"Atilde", 0xC3}, {"Auml", 0xC4}, {"Ccedil", 0xC7}, {"ETH", 0xD0}, {"Eacute", 0xC9}, {"Ecirc", 0xCA},
+        {"Egrave", 0xC8}, {"Euml", 0xCB}, {"GT", U'>'}, {"Iacute", 0xCD}, {"Icirc", 0xCE}, {"Igrave", 0xCC},
+        {"Iuml", 0xCF}, {"LT", U'<'}, {"Ntilde", 0xD1}, {"OElig", 0x152}, {"Oacute", 0xD3}, {"Ocirc", 0xD4},
+        {"Ograve", 0xD2}, {"Oslash", 0xD8}, {"Otilde", 0xD5}, {"Ouml", 0xD6}, {"QUOT", U'"'},
+        {"Scaron", 0x160}, {"THORN", 0xDE}, {"Uacute", 0xDA}, {"Ucirc", 0xDB}, {"Ugrave", 0xD9},
+        {"Uuml", 0xDC}, {"Yacute", 0xDD}, {"Yuml", 0x178}, {"Zcaron", 0x17D}, {"aacute", 0xE1},
+        {"acirc", 0xE2}, {"aelig", 0xE6}, {"agrave", 0xE0}, {"amp", U'&'}, {"apos", U'\''}, {"aring", 0xE5},
+        {"atilde", 0xE3}, {"auml", 0xE4}, {"ccedil", 0xE7}, {"divide", 0xF7}, {"eacute", 0xE9},
+        {"ecirc", 0xEA}, {"egrave", 0xE8}, {"eth", 0xF0}, {"euml", 0xEB}, {"gt", U'>'}, {"iacute", 0xED},
+        {"icirc", 0xEE}, {"igrave", 0xEC}, {"iuml", 0xEF}, {"lt", U'<'}, {"nbsp", U' '}, {"ntilde", 0xF1},
+        {"oacute", 0xF3}, {"ocirc", 0xF4}, {"oelig", 0x153}, {"ograve", 0xF2}, {"oslash", 0xF8},
+        {"otilde", 0xF5}, {"ouml", 0xF6}, {"quot", U'"'}, {"scaron", 0x161}, {"szlig", 0xDF},
+        {"thorn", 0xFE}, {"times", 0xD7}, {"uacute", 0xFA}, {"ucirc", 0xFB}, {"ugrave", 0xF9},
+        {"uuml", 0xFC}, {"yacute", 0xFD}, {"yuml", 0xFF}, {"zcaron", 0x17E}
+    };
+
+    static constexpr bool namedEntitiesSorted() {
+        for (size_t i = 1; i < std::size(NAMED_ENTITIES); ++i) {
+            if (!(NAMED_ENTITIES[i - 1].name < NAMED_ENTITIES[i].name)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static constexpr std::array<bool, 256> SPECIAL = [] {
+        std::array<bool, 256> special{};
+        for (unsigned char c : {'<', '&', ':', '.', '@', '[', ']', '`', '*', '_', '#', '~'}) {
+            special[c] = true;
+        }
+        return special;
+    }();
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+    static bool isAsciiAlnum(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    }
+
+    static char lowerAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // Case-insensitive match of `word` at text[i]
+    static bool matchesAt(const char* text, size_t length, size_t i, const char* word) {
+        size_t wordLength = std::strlen(word);
+        if (i + wordLength > length) {
+            return false;
+        }
+        for (size_t j = 0; j < wordLength; ++j) {
+            if (lowerAscii(text[i + j]) != word[j]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Position after the first occurrence of `word` at or after i, or `length`
+    static size_t skipPast(const char* text, size_t length, size_t i, const char* word) {
+        for (; i < length; ++i) {
+            if (matchesAt(text, length, i, word)) {
+                return i + std::strlen(word);
+            }
+        }
+        return length;
+    }
+
+    static Markup recognize(const char* text, size_t length, size_t i, size_t runStart) {
+        switch (text[i]) {
+            case '<':
+                return recognizeTag(text, length, i);
+            case '&':
+                return recognizeEntity(text, length, i);
+            case ':':
+            case '.':
+                return recognizeUrl(text, length, i, runStart);
+            case '@':
+                return recognizeEmail(text, length, i, runStart);
+            case ']':
+                // Markdown link or image target: [text](target)
+                if (i + 1 < length && text[i + 1] == '(') {
+                    for (size_t j = i + 2; j < length && j < i + 2 + MAX_LINK_TARGET_LENGTH; ++j) {
+                        if (text[j] == ')') {
+                            return {i, j + 1, U' '};
+                        }
+                    }
+                }
+                return {i, i + 1, U' '};
+            case '`':
+                // Code fence or inline code span
+                if (matchesAt(text, length, i, "```")) {
+                    return {i, skipPast(text, length, i + 3, "```"), U' '};
+                }
+                for (size_t j = i + 1; j < length && text[j] != '\n'; ++j) {
+                    if (text[j] == '`') {
+                        return {i, j + 1, U' '};
+                    }
+                }
+                return {i, i + 1, U' '};
+            case '#':
+                // Heading marker or hashtag, not "C#"
+                if (i > 0 && !isSpace(text[i - 1]) && text[i - 1] != '#') {
+                    return {0, 0, 0};
+                }
+                return {i, i + 1, U' '};
+            case '[':
+                return {i, i + 1, U' '};
+            default:
+                // Emphasis and strike-through markers, but not "snake_case"
+                if (i > 0 && i + 1 < length && isAsciiAlnum(text[i - 1]) && isAsciiAlnum(text[i + 1])) {
+                    return {0, 0, 0};
+                }
+                return {i, i + 1, U' '};
+        }
+    }
+
+    static Markup recognizeTag(const char* text, size_t length, size_t i) {
+        if (matchesAt(text, length, i, "<!--")) {
+            return {i, skipPast(text, length, i + 4, "-->"), U' '};
+        }
+
+        size_t nameStart = i + 1;
+        if (nameStart < length && text[nameStart] == '/') {
+            nameStart++;
+        }
+        if (nameStart >= length
+            || !(isAsciiAlnum(text[nameStart]) || text[nameStart] == '!' || text[nameStart] == '?')) {
+            return {0, 0, 0};  // "a < b"
+        }
+
+        // End of the tag, ignoring '>' inside quoted attribute values. Like link
+        // targets, tags are bounded so that text with many '<' openers and no '>'
+        // (code such as "a <b && c <d", or an unbalanced quote) stays linear.
+        size_t limit = std::min(length, nameStart + MAX_TAG_LENGTH);
+        if (std::memchr(text + nameStart, '>', limit - nameStart) == nullptr) {
+            return {0, 0, 0};
+        }
+        char quote = 0;
+        size_t end = nameStart;
+        for (; end < limit; ++end) {
+            char c = text[end];
+            if (quote != 0) {
+                quote = c == quote ? 0 : quote;
+            } else if (c == '"' || c == '\'') {
+                quote = c;
+            } else if (c == '>') {
+                break;
+            }
+        }
+        if (end >= limit) {
+            return {0, 0, 0};
+        }
+        end++;
+
+        bool closing = nameStart > i + 1;
+        if (!closing) {
+            static const char* const RAW_TEXT_TAGS[][2] = {{"script", "</script"}, {"style", "</style"}};
+            for (const auto& [rawText, closeTag] : RAW_TEXT_TAGS) {
+                if (matchesAt(text, length, nameStart, rawText) && !isAsciiAlnum(text[nameStart + std::strlen(rawText)])) {
+                    size_t close = skipPast(text, length, end, closeTag);
+                    while (close < length && text[close] != '>') {
+                        close++;
+                    }
+                    return {i, std::min(close + 1, length), U' '};
+                }
+            }
+        }
+
+        return {i, end, isInlineTag(text, length, nameStart) ? U'\0' : U' '};
+    }
+
+    static bool isInlineTag(const char* text, size_t length, size_t nameStart) {
+        static const char* const INLINE_TAGS[] = {
+            "a", "abbr", "b", "cite", "em", "font", "i", "mark", "q", "s",
+            "small", "span", "strong", "sub", "sup", "u"
+        };
+        for (const char* tag : INLINE_TAGS) {
+            size_t tagLength = std::strlen(tag);
+            if (matchesAt(text, length, nameStart, tag)
+                && nameStart + tagLength < length && !isAsciiAlnum(text[nameStart + tagLength])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static Markup recognizeEntity(const char* text, size_t length, size_t i) {
+        size_t end = i + 1;
+        while (end < length && end <= i + MAX_ENTITY_LENGTH && (isAsciiAlnum(text[end]) || text[end] == '#')) {
+            end++;
+        }
+        if (end >= length || text[end] != ';' || end == i + 1) {
+            return {0, 0, 0};
+        }
+
+        char32_t chr = 0;
+        if (text[i + 1] == '#') {
+            bool hex = i + 2 < end && lowerAscii(text[i + 2]) == 'x';
+            uint32_t value = 0;
+            for (size_t j = i + (hex ? 3 : 2); j < end && value <= 0x10FFFF; ++j) {
+                char c = lowerAscii(text[j]);
+                if (c >= '0' && c <= '9') {
+                    value = value * (hex ? 16 : 10) + (c - '0');
+                } else if (hex && c >= 'a' && c <= 'f') {
+                    value = value * 16 + (c - 'a' + 10);
+                } else {
+                    value = 0;
+                    break;
+                }
+            }
+            if (value > 0 && value <= 0x10FFFF) {
+                chr = static_cast<char32_t>(value);
+            }
+        } else {
+            static_assert(namedEntitiesSorted(), "NAMED_ENTITIES must be sorted by name");
+            std::string_view name(text + i + 1, end - i - 1);
+            const NamedEntity* entity = std::lower_bound(
+                std::begin(NAMED_ENTITIES), std::end(NAMED_ENTITIES), name,
+                [](const NamedEntity& a, std::string_view b) { return a.name < b; });
+            if (entity != std::end(NAMED_ENTITIES) && entity->name == name) {
+                chr = entity->value;
+            }
+        }
+        if (chr == 0) {
+            // Unknown entity, left as the literal text
+            return {0, 0, 0};
+        }
+        return {i, end + 1, chr};
+    }
+
+    // "scheme://..." at a ':' or "www." at a '.', up to the next space or delimiter
+    static Markup recognizeUrl(const char* text, size_t length, size_t i, size_t runStart) {
+        size_t begin;
+        if (text[i] == ':') {
+            if (!matchesAt(text, length, i + 1, "//")) {
+                return {0, 0, 0};
+            }
+            begin = i;
+            while (begin > runStart && (isAsciiAlnum(text[begin - 1]) || text[begin - 1] == '+'
+                                        || text[begin - 1] == '-' || text[begin - 1] == '.')) {
+                begin--;
+            }
+            if (begin == i) {
+                return {0, 0, 0};
+            }
+        } else {
+            if (i < runStart + 3 || !matchesAt(text, length, i - 3, "www")
+                || (i > 3 && isAsciiAlnum(text[i - 4]))) {
+                return {0, 0, 0};
+            }
+            begin = i - 3;
+        }
+
+        size_t end = i;
+        while (end < length && !isSpace(text[end]) && text[end] != '<' && text[end] != '>'
+               && text[end] != '"' && text[end] != '\'' && text[end] != ')' && text[end] != ']') {
+            end++;
+        }
+        return {begin, end, U' '};
+    }
+
+    static Markup recognizeEmail(const char* text, size_t length, size_t i, size_t runStart) {
+        auto isLocal = [](char c) {
+            return isAsciiAlnum(c) || c == '.' || c == '_' || c == '%' || c == '+' || c == '-';
+        };
+        size_t begin = i;
+        while (begin > runStart && isLocal(text[begin - 1])) {
+            begin--;
+        }
+
+        size_t end = i + 1;
+        bool dot = false;
+        while (end < length && (isAsciiAlnum(text[end]) || text[end] == '-'
+                                || (text[end] == '.' && end + 1 < length && isAsciiAlnum(text[end + 1])))) {
+            dot = dot || text[end] == '.';
+            end++;
+        }
+        if (begin == i || !dot) {
+            return {0, 0, 0};
+        }
+        return {begin, end, U' '};
+    }
+};
+
+#endif // MARKUP_STRIPPER_HPP
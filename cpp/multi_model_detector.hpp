@@ -0,0 +1,103 @@
+#ifndef MULTI_MODEL_DETECTOR_HPP
+#define MULTI_MODEL_DETECTOR_HPP
+
+#include <array>
+#include <string>
+#include <string_view>
+#include "language_detector.hpp"
+
+// weights_neg.hpp declares its tables in namespace neg_model and only makes them
+// global when asked to, so it can sit next to the primary model. If it is the
+// primary model itself, it was included by language_detector.hpp already and
+// both models below are the same tables.
+#define WHICHLANG_NEG_MODEL_NAMESPACE_ONLY
+#include "weights_neg.hpp"
+#undef WHICHLANG_NEG_MODEL_NAMESPACE_ONLY
+
+// Weight tables of one model that shares the tokenizer, seed, dimension and
+// language order of LanguageDetector.
+struct LanguageModel {
+    const float* weights;
+    const float* intercepts;
+};
+
+// Same languages in the same order, compared by code since each model has its
+// own Lang enum
+constexpr bool sameLanguages() {
+    if (std::tuple_size<decltype(neg_model::LANGUAGES)>::value != std::tuple_size<decltype(LANGUAGES)>::value) {
+        return false;
+    }
+    for (size_t i = 0; i < LANGUAGES.size(); ++i) {
+        if (neg_model::three_letter_code(neg_model::LANGUAGES[i]) != three_letter_code(LANGUAGES[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(sameLanguages(), "models must share the language list");
+static_assert(std::tuple_size<decltype(neg_model::WEIGHTS)>::value == std::tuple_size<decltype(WEIGHTS)>::value,
+              "models must share the dimension");
+
+// The model LanguageDetector was built with (WHICHLANG_WEIGHTS)
+const LanguageModel MODEL_PRIMARY = {WEIGHTS.data(), INTERCEPTS};
+const LanguageModel MODEL_NEG = {neg_model::WEIGHTS.data(), neg_model::INTERCEPTS};
+
+template <size_t N>
+struct MultiModelResult {
+    std::array<Lang, N> languages;  // argmax of each model, in the order the models were passed
+    Lang ensemble;                  // argmax of the scores averaged over all models
+};
+
+// Tokenizes and hashes a text once and accumulates every model's scores in the
+// same loop, so comparing, ensembling or shadow-scoring a candidate model only
+// costs its extra adds.
+class MultiModelDetector {
+public:
+    template <size_t N>
+    static MultiModelResult<N> detectLanguages(std::string_view text,
+                                               const std::array<LanguageModel, N>& models) {
+        constexpr size_t numLanguages = LanguageDetector::NUM_LANGUAGES;
+        std::array<std::array<float, numLanguages>, N> scores{};
+        uint32_t numFeatures = 0;
+
+        LanguageDetector::emitBuckets(text, [&](uint32_t bucket) {
+            numFeatures++;
+            size_t idx = bucket * numLanguages;
+
+            for (size_t m = 0; m < N; ++m) {
+                const float* row = models[m].weights + idx;
+                for (size_t i = 0; i < numLanguages; ++i) {
+                    scores[m][i] += row[i];
+                }
+            }
+        });
+
+        MultiModelResult<N> result;
+        if (numFeatures == 0) {
+            // Default to English
+            result.languages.fill(Lang::En);
+            result.ensemble = Lang::En;
+            return result;
+        }
+
+        float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(numFeatures));
+        std::array<float, numLanguages> ensemble{};
+        for (size_t m = 0; m < N; ++m) {
+            for (size_t i = 0; i < numLanguages; ++i) {
+                scores[m][i] = scores[m][i] * sqrtInvNumFeatures + models[m].intercepts[i];
+                ensemble[i] += scores[m][i];
+            }
+            auto maxIt = std::max_element(scores[m].begin(), scores[m].end());
+            result.languages[m] = LANGUAGES[std::distance(scores[m].begin(), maxIt)];
+        }
+
+        // Averaging divides every language by N, which keeps the argmax of the sum
+        auto maxIt = std::max_element(ensemble.begin(), ensemble.end());
+        result.ensemble = LANGUAGES[std::distance(ensemble.begin(), maxIt)];
+
+        return result;
+    }
+};
+
+#endif // MULTI_MODEL_DETECTOR_HPP
@@ -0,0 +1,113 @@
+#ifndef PARALLEL_DETECTOR_HPP
+#define PARALLEL_DETECTOR_HPP
+
+#include <array>
+#include <atomic>
+#include <memory_resource>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "partial_score.hpp"
+
+// Scores one large document on several threads. Scores are plain sums normalized
+// by the feature count, so the text is cut at positions where the tokenizer state
+// is known (see LanguageDetector::findSplitPoint), every chunk is summed on its
+// own and the partial sums and counts are added up. The tokens are exactly those
+// of the serial call; only the order of the float additions differs. The chunk,
+// score and thread lists are allocated from `memory`.
+class ParallelDetector {
+public:
+    static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;  // 1 MiB
+
+    static Lang detectLanguage(std::string_view text,
+                               size_t numThreads = std::thread::hardware_concurrency(),
+                               size_t chunkSize = MIN_CHUNK_SIZE,
+                               std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        numThreads = std::max<size_t>(numThreads, 1);
+        chunkSize = std::max<size_t>(chunkSize, 1);
+        if (numThreads == 1 || text.size() < 2 * chunkSize) {
+            return LanguageDetector::detectLanguage(text);
+        }
+
+        std::pmr::vector<Chunk> chunks = splitChunks(text, chunkSize, memory);
+        std::pmr::vector<PartialScore> partials(chunks.size(), memory);
+        std::atomic<size_t> nextChunk{0};
+
+        auto worker = [&]() {
+            for (size_t c = nextChunk++; c < chunks.size(); c = nextChunk++) {
+                const Chunk& chunk = chunks[c];
+                LanguageDetector::TokenizerState state = chunk.state;
+                PartialScore partial;
+
+                LanguageDetector::emitBuckets(text.data() + chunk.begin, chunk.end - chunk.begin, state,
+                                              [&](uint32_t bucket) {
+                    partial.numFeatures++;
+                    LanguageDetector::addBucket(partial.scores, bucket);
+                });
+                partials[c] = partial;
+            }
+        };
+
+        std::pmr::vector<std::thread> threads(memory);
+        size_t numWorkers = std::min(numThreads, chunks.size());
+        threads.reserve(numWorkers - 1);
+        for (size_t t = 1; t < numWorkers; ++t) {
+            try {
+                threads.emplace_back(worker);
+            } catch (const std::system_error&) {
+                // Out of threads: the started ones and this one take the remaining chunks
+                break;
+            }
+        }
+        worker();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        PartialScore total;
+        for (const PartialScore& partial : partials) {
+            total.merge(partial);
+        }
+
+        return total.finalize();
+    }
+
+    // Bytes [begin, end) of a text, tokenized from `state`
+    struct Chunk {
+        size_t begin;
+        size_t end;
+        LanguageDetector::TokenizerState state;
+    };
+
+    // Cuts the text roughly every chunkSize bytes at the first safe split point
+    // after each target. A target with no split point before the next one is
+    // dropped and its chunk merges into the following one. Summing the chunks'
+    // partial scores gives the features of the whole text.
+    static std::pmr::vector<Chunk> splitChunks(std::string_view text, size_t chunkSize,
+                                               std::pmr::memory_resource* memory) {
+        std::pmr::vector<Chunk> chunks(memory);
+        Chunk current{0, 0, LanguageDetector::TokenizerState()};
+
+        for (size_t target = chunkSize; target < text.size(); target += chunkSize) {
+            if (target <= current.begin) {
+                continue;
+            }
+            LanguageDetector::TokenizerState state;
+            size_t split = LanguageDetector::findSplitPoint(text.data(), text.size(), target,
+                                                            target + chunkSize, state);
+            if (split >= text.size() || split >= target + chunkSize) {
+                continue;
+            }
+            current.end = split;
+            chunks.push_back(current);
+            current = Chunk{split, 0, state};
+        }
+
+        current.end = text.size();
+        chunks.push_back(current);
+        return chunks;
+    }
+};
+
+#endif // PARALLEL_DETECTOR_HPP
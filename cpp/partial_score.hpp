@@ -0,0 +1,127 @@
+#ifndef PARTIAL_SCORE_HPP
+#define PARTIAL_SCORE_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+#include "language_detector.hpp"
+
+// Raw accumulator behind detectLanguage: the score sums before normalization and
+// the number of features they came from. Partial scores of different texts can
+// be merged in any order and finalized once, so the language of an entity made
+// of many messages (spread over threads or machines) is computed without
+// re-reading the texts. Each added text is tokenized on its own.
+struct PartialScore {
+    std::array<float, LanguageDetector::NUM_LANGUAGES> scores{};
+    uint64_t numFeatures = 0;
+
+    // "WLPS", format version, language count, model fingerprint, feature count, sums
+    static constexpr size_t SERIALIZED_SIZE = 4 + 2 + 2 + 4 + 8 + 4 * LanguageDetector::NUM_LANGUAGES;
+
+    static PartialScore fromText(std::string_view text) {
+        PartialScore partial;
+        partial.add(text);
+        return partial;
+    }
+
+    void add(std::string_view text) {
+        LanguageDetector::emitBuckets(text, [&](uint32_t bucket) {
+            numFeatures++;
+            LanguageDetector::addBucket(scores, bucket);
+        });
+    }
+
+    void merge(const PartialScore& other) {
+        for (size_t i = 0; i < scores.size(); ++i) {
+            scores[i] += other.scores[i];
+        }
+        numFeatures += other.numFeatures;
+    }
+
+    Lang finalize() const {
+        return LanguageDetector::finalizeScores(scores, numFeatures);
+    }
+
+    // Writes SERIALIZED_SIZE bytes in little-endian order to `out`
+    void serialize(uint8_t* out) const {
+        std::memcpy(out, "WLPS", 4);
+        writeLittleEndian(out + 4, FORMAT_VERSION, 2);
+        writeLittleEndian(out + 6, scores.size(), 2);
+        writeLittleEndian(out + 8, modelFingerprint(), 4);
+        writeLittleEndian(out + 12, numFeatures, 8);
+        for (size_t i = 0; i < scores.size(); ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &scores[i], sizeof(bits));
+            writeLittleEndian(out + 20 + 4 * i, bits, 4);
+        }
+    }
+
+    std::pmr::string serialize(std::pmr::memory_resource* memory = std::pmr::get_default_resource()) const {
+        std::pmr::string bytes(SERIALIZED_SIZE, '\0', memory);
+        serialize(reinterpret_cast<uint8_t*>(&bytes[0]));
+        return bytes;
+    }
+
+    // Reads a serialized partial score. Returns false, leaving `out` untouched,
+    // if the bytes are truncated or come from another format or model.
+    static bool deserialize(const uint8_t* data, size_t size, PartialScore& out) {
+        if (size < SERIALIZED_SIZE || std::memcmp(data, "WLPS", 4) != 0
+            || readLittleEndian(data + 4, 2) != FORMAT_VERSION
+            || readLittleEndian(data + 6, 2) != LanguageDetector::NUM_LANGUAGES
+            || readLittleEndian(data + 8, 4) != modelFingerprint()) {
+            return false;
+        }
+
+        out.numFeatures = readLittleEndian(data + 12, 8);
+        for (size_t i = 0; i < out.scores.size(); ++i) {
+            uint32_t bits = static_cast<uint32_t>(readLittleEndian(data + 20 + 4 * i, 4));
+            std::memcpy(&out.scores[i], &bits, sizeof(bits));
+        }
+        return true;
+    }
+
+    static bool deserialize(std::string_view bytes, PartialScore& out) {
+        return deserialize(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size(), out);
+    }
+
+private:
+    static constexpr uint64_t FORMAT_VERSION = 1;
+
+    // FNV-1a over the weight and intercept bits, so partial scores of different
+    // models are never merged by accident
+    static uint32_t modelFingerprint() {
+        static const uint32_t fingerprint = [] {
+            uint32_t hash = 2166136261u;
+            auto mix = [&](const float* values, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    uint32_t bits;
+                    std::memcpy(&bits, &values[i], sizeof(bits));
+                    hash = (hash ^ bits) * 16777619u;
+                }
+            };
+            mix(WEIGHTS.data(), WEIGHTS.size());
+            mix(INTERCEPTS, LanguageDetector::NUM_LANGUAGES);
+            return hash;
+        }();
+        return fingerprint;
+    }
+
+    static void writeLittleEndian(uint8_t* out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; ++i) {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+    static uint64_t readLittleEndian(const uint8_t* data, size_t bytes) {
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        }
+        return value;
+    }
+};
+
+#endif // PARTIAL_SCORE_HPP
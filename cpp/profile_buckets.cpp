@@ -0,0 +1,169 @@
+// Bucket hit profiling and hot/cold model layout.
+//
+// Counts how often each hashed bucket is hit on a representative corpus, then exports
+// the model with its rows reordered by descending hit count plus a BUCKET_REMAP table,
+// so the rows that almost every document touches sit contiguously at the front of
+// WEIGHTS. language_detector_hot.hpp reads the exported header; scores are
+// bit-identical to the original model since only the row order changes.
+//
+// Build against any model, e.g.
+//   g++ -std=c++17 -O2 -DWHICHLANG_WEIGHTS='"weights_neg.hpp"' profile_buckets.cpp -o profile_buckets
+// Run:
+//   ./profile_buckets [data_dir] [output_header]
+// e.g. on the lingua test sentences, the corpus the layout should be profiled on:
+//   ./profile_buckets ../lingua/language-testdata/sentences weights_4096_hot.hpp
+// The header records the corpus and the command line. None is checked in: the
+// layout is only as good as the corpus it was profiled on, so generate it from
+// the data the detector will see.
+// To compare cache and TLB behaviour, run a harness built with language_detector.hpp and
+// one built with language_detector_hot.hpp under
+//   perf stat -e dTLB-load-misses,l2_rqsts.miss <harness>
+#include "language_detector.hpp"
+#include "tool_helpers.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <iomanip>
+
+constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+constexpr size_t DIMENSION = LanguageDetector::DIMENSION;
+
+void exportHotLayout(const std::string& outputFile, const std::string& command, const std::string& corpus,
+                     uint64_t totalHits, const std::vector<uint32_t>& remap, const std::vector<float>& weights) {
+    std::ofstream file(outputFile);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + outputFile);
+    }
+
+    file << "// Auto-generated hot/cold row layout of " << WHICHLANG_WEIGHTS << "\n";
+    file << "// Rows ordered by bucket hit count on " << corpus << " (" << totalHits << " hits)\n";
+    file << "// Generated by: " << command << " (built with WHICHLANG_WEIGHTS=" << WHICHLANG_WEIGHTS << ")\n";
+    file << "// Row of bucket b is WEIGHTS[BUCKET_REMAP[b] * " << NUM_LANGUAGES << " ...]\n";
+    file << "#pragma once\n#include <array>\n#include <cstdint>\n#include <string_view>\n\n";
+
+    file << "enum class Lang {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "    " << enumName(code) << ",  // " << code << "\n";
+    }
+    file << "};\n\n";
+
+    file << "constexpr std::string_view three_letter_code(Lang language) {\n    switch (language) {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "        case Lang::" << enumName(code) << ": return \"" << code << "\";\n";
+    }
+    file << "    }\n    return \"unknown\";\n}\n\n";
+
+    file << "constexpr std::array<Lang, " << NUM_LANGUAGES << "> LANGUAGES = {\n";
+    for (Lang lang : LANGUAGES) {
+        file << "    Lang::" << enumName(three_letter_code(lang)) << ",\n";
+    }
+    file << "};\n\n";
+
+    file << "const std::array<uint16_t, " << remap.size() << "> BUCKET_REMAP = {\n";
+    writeArray(file, remap);
+    file << "};\n\n";
+
+    file << "const std::array<float, " << weights.size() << "> WEIGHTS = {\n";
+    writeArray(file, weights);
+    file << "};\n\n";
+
+    file << "const float INTERCEPTS[" << NUM_LANGUAGES << "] = {\n";
+    writeArray(file, INTERCEPTS, NUM_LANGUAGES);
+    file << "};\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDirectory = "../lingua/language-testdata/sentences"; // Default directory
+    std::string outputFile;
+
+    if (argc > 1) {
+        dataDirectory = argv[1];
+    }
+    if (argc > 2) {
+        outputFile = argv[2];
+    } else {
+        std::string model = WHICHLANG_WEIGHTS;
+        outputFile = model.substr(0, model.rfind('.')) + "_hot.hpp";
+    }
+    static_assert(DIMENSION <= 65536, "BUCKET_REMAP is exported as uint16_t");
+
+    std::vector<uint64_t> hits(DIMENSION, 0);
+    uint64_t totalHits = 0;
+    size_t numTexts = 0;
+
+    try {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+                continue;
+            }
+            for (const std::string& text : readWordsFromFile(entry.path().string())) {
+                LanguageDetector::emitBuckets(text, [&](uint32_t bucket) {
+                    hits[bucket]++;
+                    totalHits++;
+                });
+                numTexts++;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        std::cerr << "Make sure the data directory exists and contains .txt files\n";
+        return 1;
+    }
+
+    std::cout << "Profiled " << numTexts << " texts, " << totalHits << " bucket hits\n";
+
+    // Slot order: hottest bucket first, ties broken by bucket index to keep the output stable
+    std::vector<uint32_t> order(DIMENSION);
+    for (size_t i = 0; i < DIMENSION; ++i) {
+        order[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return hits[a] > hits[b]; });
+
+    std::vector<uint32_t> remap(DIMENSION);
+    std::vector<float> weights(DIMENSION * NUM_LANGUAGES);
+    for (size_t slot = 0; slot < DIMENSION; ++slot) {
+        uint32_t bucket = order[slot];
+        remap[bucket] = static_cast<uint32_t>(slot);
+        std::copy(&WEIGHTS[bucket * NUM_LANGUAGES], &WEIGHTS[bucket * NUM_LANGUAGES] + NUM_LANGUAGES,
+                  &weights[slot * NUM_LANGUAGES]);
+    }
+
+    // How much of the traffic the first N rows of each layout absorb
+    std::cout << "\nHIT COVERAGE BY LEADING ROWS\n";
+    std::cout << std::string(70, '-') << "\n";
+    std::cout << std::setw(8) << "Rows" << std::setw(12) << "KiB" << std::setw(10) << "Pages"
+              << std::setw(18) << "Hot layout" << std::setw(18) << "Original" << "\n";
+    std::cout << std::string(70, '-') << "\n";
+    size_t rowBytes = NUM_LANGUAGES * sizeof(float);
+    for (size_t rows : {16, 64, 256, 512, 1024, 2048, 4096}) {
+        if (rows > DIMENSION) {
+            break;
+        }
+        uint64_t hotHits = 0;
+        uint64_t originalHits = 0;
+        for (size_t i = 0; i < rows; ++i) {
+            hotHits += hits[order[i]];
+            originalHits += hits[i];
+        }
+        std::cout << std::setw(8) << rows << std::setw(12) << (rows * rowBytes / 1024)
+                  << std::setw(10) << ((rows * rowBytes + 4095) / 4096)
+                  << std::setw(17) << std::fixed << std::setprecision(2)
+                  << (totalHits > 0 ? 100.0 * hotHits / totalHits : 0.0) << "%"
+                  << std::setw(17) << (totalHits > 0 ? 100.0 * originalHits / totalHits : 0.0) << "%\n";
+    }
+
+    try {
+        exportHotLayout(outputFile, commandLine(argc, argv), dataDirectory, totalHits, remap, weights);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "\nHot/cold layout exported to " << outputFile << "\n";
+
+    return 0;
+}
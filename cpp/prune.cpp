@@ -0,0 +1,307 @@
+// Magnitude pruning of a trained weights_*.hpp model into a sparse CSR model.
+//
+// Sweeps absolute-value thresholds and per-bucket top-k, and for each operating point
+// reports non-zeros, model size, scoring throughput and accuracy / agreement with the
+// dense model on the lingua test data. The chosen point is exported as a header for
+// language_detector_sparse.hpp.
+//
+// Build against any model, e.g.
+//   g++ -std=c++17 -O2 -DWHICHLANG_WEIGHTS='"weights_neg.hpp"' prune.cpp -o prune
+// Run:
+//   ./prune [data_dir] [threshold|topk] [value] [output_header]
+// Pick the operating point from the sweep on the lingua test sentences, then
+// export it, e.g.
+//   ./prune ../lingua/language-testdata/sentences threshold 0.1 weights_4096_sparse.hpp
+// The header records the command line and the accuracy of the exported point.
+// None is checked in, since the threshold has to be chosen on that data.
+#include "language_detector.hpp"
+#include "language_codes.hpp"
+#include "tool_helpers.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <chrono>
+#include <sstream>
+
+constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+constexpr size_t DIMENSION = LanguageDetector::DIMENSION;
+
+// Compressed sparse rows: the non-zeros of bucket b are entries
+// [rowOffsets[b], rowOffsets[b + 1]) of langs / weights.
+struct SparseModel {
+    std::string name;
+    std::vector<uint32_t> rowOffsets;
+    std::vector<uint8_t> langs;
+    std::vector<float> weights;
+
+    size_t bytes() const {
+        return rowOffsets.size() * sizeof(uint32_t) + langs.size() * sizeof(uint8_t)
+             + weights.size() * sizeof(float);
+    }
+};
+
+SparseModel pruneByThreshold(float threshold) {
+    SparseModel model;
+    std::ostringstream name;
+    name << "|w| >= " << threshold;
+    model.name = name.str();
+    model.rowOffsets.push_back(0);
+
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            float weight = WEIGHTS[bucket * NUM_LANGUAGES + i];
+            if (std::abs(weight) >= threshold) {
+                model.langs.push_back(static_cast<uint8_t>(i));
+                model.weights.push_back(weight);
+            }
+        }
+        model.rowOffsets.push_back(static_cast<uint32_t>(model.weights.size()));
+    }
+    return model;
+}
+
+SparseModel pruneTopK(size_t k) {
+    SparseModel model;
+    model.name = "top-" + std::to_string(k);
+    model.rowOffsets.push_back(0);
+
+    std::vector<size_t> order(NUM_LANGUAGES);
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        const float* row = &WEIGHTS[bucket * NUM_LANGUAGES];
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            order[i] = i;
+        }
+        size_t keep = std::min(k, NUM_LANGUAGES);
+        std::partial_sort(order.begin(), order.begin() + keep, order.end(),
+                          [&](size_t a, size_t b) { return std::abs(row[a]) > std::abs(row[b]); });
+        // Keep language order within a row so the scorer walks scores forward
+        std::sort(order.begin(), order.begin() + keep);
+
+        for (size_t j = 0; j < keep; ++j) {
+            model.langs.push_back(static_cast<uint8_t>(order[j]));
+            model.weights.push_back(row[order[j]]);
+        }
+        model.rowOffsets.push_back(static_cast<uint32_t>(model.weights.size()));
+    }
+    return model;
+}
+
+void exportSparse(const std::string& outputFile, const SparseModel& model, const std::string& command,
+                  const std::string& evaluation) {
+    std::ofstream file(outputFile);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + outputFile);
+    }
+
+    file << "// Auto-generated magnitude-pruned sparse model from " << WHICHLANG_WEIGHTS << "\n";
+    file << "// Pruning: " << model.name << ", " << model.weights.size() << " of "
+         << (DIMENSION * NUM_LANGUAGES) << " weights kept, " << model.bytes() << " bytes\n";
+    file << "// Generated by: " << command << " (built with WHICHLANG_WEIGHTS=" << WHICHLANG_WEIGHTS << ")\n";
+    file << "// " << evaluation << "\n";
+    file << "// CSR rows: bucket b owns entries [SPARSE_ROW_OFFSETS[b], SPARSE_ROW_OFFSETS[b + 1])\n";
+    file << "#pragma once\n#include <array>\n#include <cstdint>\n#include <string_view>\n\n";
+
+    file << "enum class Lang {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "    " << enumName(code) << ",  // " << code << "\n";
+    }
+    file << "};\n\n";
+
+    file << "constexpr std::string_view three_letter_code(Lang language) {\n    switch (language) {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "        case Lang::" << enumName(code) << ": return \"" << code << "\";\n";
+    }
+    file << "    }\n    return \"unknown\";\n}\n\n";
+
+    file << "constexpr std::array<Lang, " << NUM_LANGUAGES << "> LANGUAGES = {\n";
+    for (Lang lang : LANGUAGES) {
+        file << "    Lang::" << enumName(three_letter_code(lang)) << ",\n";
+    }
+    file << "};\n\n";
+
+    file << "const std::array<uint32_t, " << model.rowOffsets.size() << "> SPARSE_ROW_OFFSETS = {\n";
+    writeArray(file, model.rowOffsets);
+    file << "};\n\n";
+
+    file << "const std::array<uint8_t, " << model.langs.size() << "> SPARSE_LANGS = {\n";
+    writeArray(file, model.langs);
+    file << "};\n\n";
+
+    file << "const std::array<float, " << model.weights.size() << "> SPARSE_WEIGHTS = {\n";
+    writeArray(file, model.weights);
+    file << "};\n\n";
+
+    file << "const float INTERCEPTS[" << NUM_LANGUAGES << "] = {\n";
+    writeArray(file, INTERCEPTS, NUM_LANGUAGES);
+    file << "};\n";
+}
+
+size_t finalize(std::vector<float>& scores, uint32_t numFeatures) {
+    float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(numFeatures));
+    for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+        scores[i] = scores[i] * sqrtInvNumFeatures + INTERCEPTS[i];
+    }
+    return std::distance(scores.begin(), std::max_element(scores.begin(), scores.end()));
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDirectory = "../lingua/language-testdata/sentences"; // Default directory
+    std::string mode = "threshold";
+    double value = 0.1;
+    std::string outputFile;
+
+    if (argc > 1) {
+        dataDirectory = argv[1];
+    }
+    if (argc > 2) {
+        mode = argv[2];
+    }
+    if (argc > 3) {
+        value = std::stod(argv[3]);
+    }
+    if (argc > 4) {
+        outputFile = argv[4];
+    } else {
+        std::string model = WHICHLANG_WEIGHTS;
+        outputFile = model.substr(0, model.rfind('.')) + "_sparse.hpp";
+    }
+    if (mode != "topk" && mode != "threshold") {
+        std::cerr << "Pruning mode must be 'topk' or 'threshold'\n";
+        return 1;
+    }
+
+    std::cout << "Pruning " << WHICHLANG_WEIGHTS << " (" << DIMENSION << " x " << NUM_LANGUAGES << ")\n";
+
+    std::vector<SparseModel> models;
+    for (float threshold : {0.01f, 0.02f, 0.05f, 0.1f, 0.2f, 0.3f, 0.5f}) {
+        models.push_back(pruneByThreshold(threshold));
+    }
+    for (size_t k : {4, 8, 16, 24, 32, 48}) {
+        if (k < NUM_LANGUAGES) {
+            models.push_back(pruneTopK(k));
+        }
+    }
+
+    // Tokenize the evaluation set once; every operating point scores the same buckets
+    std::vector<std::vector<uint32_t>> documents;
+    std::vector<size_t> expected;
+    if (std::filesystem::is_directory(dataDirectory)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+                continue;
+            }
+            std::string filename = entry.path().filename().string();
+            std::optional<Lang> language = LanguageCodes::fromCode(std::string_view(filename).substr(0, 2));
+            if (!language) {
+                continue;
+            }
+            for (const std::string& text : readWordsFromFile(entry.path().string())) {
+                std::vector<uint32_t> buckets;
+                LanguageDetector::emitBuckets(text, [&](uint32_t bucket) { buckets.push_back(bucket); });
+                if (!buckets.empty()) {
+                    documents.push_back(std::move(buckets));
+                    expected.push_back(LanguageCodes::index(*language));
+                }
+            }
+        }
+        std::cout << "Evaluating on " << documents.size() << " texts from " << dataDirectory << "\n";
+    } else {
+        std::cout << "Data directory " << dataDirectory << " not found, reporting sizes only\n";
+    }
+
+    std::vector<float> scores(NUM_LANGUAGES);
+    std::vector<size_t> densePredictions;
+    int denseCorrect = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t d = 0; d < documents.size(); ++d) {
+        std::fill(scores.begin(), scores.end(), 0.0f);
+        for (uint32_t bucket : documents[d]) {
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                scores[i] += WEIGHTS[bucket * NUM_LANGUAGES + i];
+            }
+        }
+        densePredictions.push_back(finalize(scores, static_cast<uint32_t>(documents[d].size())));
+        denseCorrect += (densePredictions.back() == expected[d]);
+    }
+    double denseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    size_t denseBytes = DIMENSION * NUM_LANGUAGES * sizeof(float);
+    size_t numDocuments = documents.size();
+
+    std::cout << "\nMEMORY / THROUGHPUT / ACCURACY\n";
+    std::cout << std::string(86, '-') << "\n";
+    std::cout << std::setw(16) << "Model" << std::setw(12) << "Non-zeros" << std::setw(12) << "KiB"
+              << std::setw(14) << "ns/text" << std::setw(14) << "Accuracy" << std::setw(18) << "Agreement" << "\n";
+    std::cout << std::string(86, '-') << "\n";
+    std::cout << std::setw(16) << "dense" << std::setw(12) << (DIMENSION * NUM_LANGUAGES)
+              << std::setw(12) << (denseBytes / 1024)
+              << std::setw(14) << std::fixed << std::setprecision(1)
+              << (numDocuments > 0 ? 1e9 * denseSeconds / numDocuments : 0.0)
+              << std::setw(13) << std::setprecision(2)
+              << (numDocuments > 0 ? 100.0 * denseCorrect / numDocuments : 0.0) << "%"
+              << std::setw(17) << 100.0 << "%\n";
+
+    // Returns the scoring time in seconds
+    auto evaluate = [&](const SparseModel& model, int& correct, int& agree) {
+        correct = 0;
+        agree = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (size_t d = 0; d < documents.size(); ++d) {
+            std::fill(scores.begin(), scores.end(), 0.0f);
+            for (uint32_t bucket : documents[d]) {
+                for (uint32_t j = model.rowOffsets[bucket]; j < model.rowOffsets[bucket + 1]; ++j) {
+                    scores[model.langs[j]] += model.weights[j];
+                }
+            }
+            size_t prediction = finalize(scores, static_cast<uint32_t>(documents[d].size()));
+            correct += (prediction == expected[d]);
+            agree += (prediction == densePredictions[d]);
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    for (const SparseModel& model : models) {
+        int correct;
+        int agree;
+        double seconds = evaluate(model, correct, agree);
+
+        std::cout << std::setw(16) << model.name << std::setw(12) << model.weights.size()
+                  << std::setw(12) << (model.bytes() / 1024)
+                  << std::setw(14) << std::setprecision(1)
+                  << (numDocuments > 0 ? 1e9 * seconds / numDocuments : 0.0)
+                  << std::setw(13) << std::setprecision(2)
+                  << (numDocuments > 0 ? 100.0 * correct / numDocuments : 0.0) << "%"
+                  << std::setw(17) << (numDocuments > 0 ? 100.0 * agree / numDocuments : 0.0) << "%\n";
+    }
+
+    SparseModel chosen = mode == "topk" ? pruneTopK(static_cast<size_t>(value))
+                                        : pruneByThreshold(static_cast<float>(value));
+
+    // The command and the accuracy of the chosen point go into the header
+    std::ostringstream evaluation;
+    if (numDocuments > 0) {
+        int correct;
+        int agree;
+        evaluate(chosen, correct, agree);
+        evaluation << "Accuracy on " << dataDirectory << " (" << numDocuments << " texts): " << std::fixed
+                   << std::setprecision(2) << 100.0 * correct / numDocuments << "% (dense "
+                   << 100.0 * denseCorrect / numDocuments << "%), agreement with dense "
+                   << 100.0 * agree / numDocuments << "%";
+    } else {
+        evaluation << "Not evaluated: " << dataDirectory << " not found";
+    }
+    try {
+        exportSparse(outputFile, chosen, commandLine(argc, argv), evaluation.str());
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "\n" << chosen.name << " model exported to " << outputFile << "\n";
+
+    return 0;
+}
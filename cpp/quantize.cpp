@@ -0,0 +1,254 @@
+// Export of a trained weights_*.hpp model as a freestanding model header.
+//
+// The header holds the model in plain C arrays with no standard library types, for
+// language_detector_freestanding.hpp. Weights are kept as float or quantized to int8
+// with one scale per language: WEIGHTS[b * L + l] * WEIGHT_SCALES[l] ~= weight, so a
+// score is an integer sum scaled once per text. Reports the quantization error and the
+// accuracy / agreement with the float model on the lingua test data.
+//
+// Build against any model, e.g.
+//   g++ -std=c++17 -O2 -DWHICHLANG_WEIGHTS='"weights_64.hpp"' quantize.cpp -o quantize
+// Run:
+//   ./quantize [data_dir] [float|int8] [output_header]
+// The header records the command line and, when data_dir exists, the accuracy and
+// agreement with the float model measured on it. The quantization itself does not
+// depend on the data.
+#include "language_detector.hpp"
+#include "language_codes.hpp"
+#include "tool_helpers.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <sstream>
+#include <type_traits>
+
+constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+constexpr size_t DIMENSION = LanguageDetector::DIMENSION;
+
+struct QuantizedModel {
+    std::vector<int8_t> weights;  // DIMENSION x NUM_LANGUAGES, row-major
+    std::vector<float> scales;    // one per language
+};
+
+QuantizedModel quantize() {
+    QuantizedModel model;
+    model.scales.assign(NUM_LANGUAGES, 0.0f);
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            model.scales[i] = std::max(model.scales[i], std::abs(WEIGHTS[bucket * NUM_LANGUAGES + i]) / 127.0f);
+        }
+    }
+
+    model.weights.resize(DIMENSION * NUM_LANGUAGES);
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            float scale = model.scales[i];
+            float q = scale > 0 ? std::round(WEIGHTS[bucket * NUM_LANGUAGES + i] / scale) : 0.0f;
+            model.weights[bucket * NUM_LANGUAGES + i] = static_cast<int8_t>(std::max(-127.0f, std::min(127.0f, q)));
+        }
+    }
+    return model;
+}
+
+void exportModel(const std::string& outputFile, bool int8, const QuantizedModel& model, const std::string& command,
+                 const std::string& evaluation) {
+    std::ofstream file(outputFile);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + outputFile);
+    }
+
+    file << "// Auto-generated freestanding model from " << WHICHLANG_WEIGHTS << "\n";
+    if (int8) {
+        file << "// int8 weights, one scale per language: WEIGHTS[b * " << NUM_LANGUAGES
+             << " + l] * WEIGHT_SCALES[l] ~= weight\n";
+    } else {
+        file << "// float weights, WEIGHT_SCALES are all 1\n";
+    }
+    file << "// Generated by: " << command << " (built with WHICHLANG_WEIGHTS=" << WHICHLANG_WEIGHTS << ")\n";
+    file << "// " << evaluation << "\n";
+    file << "// Plain arrays only, for language_detector_freestanding.hpp\n";
+    file << "#pragma once\n#include <cstddef>\n#include <cstdint>\n\n";
+
+    file << "enum class Lang {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "    " << enumName(code) << ",  // " << code << "\n";
+    }
+    file << "};\n\n";
+
+    file << "constexpr const char* three_letter_code(Lang language) {\n    switch (language) {\n";
+    for (Lang lang : LANGUAGES) {
+        std::string_view code = three_letter_code(lang);
+        file << "        case Lang::" << enumName(code) << ": return \"" << code << "\";\n";
+    }
+    file << "    }\n    return \"unknown\";\n}\n\n";
+
+    file << "constexpr Lang LANGUAGES[" << NUM_LANGUAGES << "] = {\n";
+    for (Lang lang : LANGUAGES) {
+        file << "    Lang::" << enumName(three_letter_code(lang)) << ",\n";
+    }
+    file << "};\n\n";
+
+    if (int8) {
+        file << "const int8_t WEIGHTS[" << DIMENSION * NUM_LANGUAGES << "] = {\n";
+        writeArray(file, model.weights.data(), model.weights.size(), 8);
+        file << "};\n\n";
+        file << "const float WEIGHT_SCALES[" << NUM_LANGUAGES << "] = {\n";
+        file << std::scientific << std::setprecision(9);
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            file << (i % 4 == 0 ? "    " : " ") << model.scales[i] << "f" << (i + 1 < NUM_LANGUAGES ? "," : "")
+                 << (i % 4 == 3 || i + 1 == NUM_LANGUAGES ? "\n" : "");
+        }
+        file << "};\n\n";
+    } else {
+        file << "const float WEIGHTS[" << DIMENSION * NUM_LANGUAGES << "] = {\n";
+        writeArray(file, WEIGHTS.data(), WEIGHTS.size());
+        file << "};\n\n";
+        std::vector<float> ones(NUM_LANGUAGES, 1.0f);
+        file << "const float WEIGHT_SCALES[" << NUM_LANGUAGES << "] = {\n";
+        writeArray(file, ones.data(), ones.size());
+        file << "};\n\n";
+    }
+
+    file << "const float INTERCEPTS[" << NUM_LANGUAGES << "] = {\n";
+    writeArray(file, INTERCEPTS, NUM_LANGUAGES);
+    file << "};\n";
+}
+
+size_t argmax(const std::vector<double>& scores) {
+    return std::distance(scores.begin(), std::max_element(scores.begin(), scores.end()));
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDirectory = "../lingua/language-testdata/sentences"; // Default directory
+    std::string format = "int8";
+    std::string outputFile;
+
+    if (argc > 1) {
+        dataDirectory = argv[1];
+    }
+    if (argc > 2) {
+        format = argv[2];
+    }
+    if (format != "int8" && format != "float") {
+        std::cerr << "Format must be int8 or float\n";
+        return 1;
+    }
+    if (argc > 3) {
+        outputFile = argv[3];
+    } else {
+        std::string model = WHICHLANG_WEIGHTS;
+        outputFile = model.substr(0, model.rfind('.')) + "_" + format + ".hpp";
+    }
+    bool int8 = format == "int8";
+
+    std::cout << "Exporting " << WHICHLANG_WEIGHTS << " (" << DIMENSION << " x " << NUM_LANGUAGES << ") as "
+              << format << "\n";
+
+    QuantizedModel model = quantize();
+    double maxError = 0.0;
+    double sumSquaredError = 0.0;
+    double sumSquared = 0.0;
+    for (size_t bucket = 0; bucket < DIMENSION; ++bucket) {
+        for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+            double weight = WEIGHTS[bucket * NUM_LANGUAGES + i];
+            double error = model.weights[bucket * NUM_LANGUAGES + i] * static_cast<double>(model.scales[i]) - weight;
+            maxError = std::max(maxError, std::abs(error));
+            sumSquaredError += error * error;
+            sumSquared += weight * weight;
+        }
+    }
+    size_t weightBytes = DIMENSION * NUM_LANGUAGES * (int8 ? sizeof(int8_t) : sizeof(float));
+    std::cout << "Weight tables: " << weightBytes << " bytes (float: "
+              << DIMENSION * NUM_LANGUAGES * sizeof(float) << ")\n";
+    std::cout << "int8 max abs error: " << std::scientific << std::setprecision(3) << maxError
+              << ", rel. Frob. error: " << std::sqrt(sumSquaredError / std::max(sumSquared, 1e-300)) << "\n";
+
+    // The quantization only depends on the model; the data measures its effect
+    std::ostringstream evaluation;
+    if (std::filesystem::is_directory(dataDirectory)) {
+        std::cout << "\nEvaluating on " << dataDirectory << "...\n";
+
+        std::vector<double> full(NUM_LANGUAGES);
+        std::vector<int64_t> quantized(NUM_LANGUAGES);
+        std::vector<double> scores(NUM_LANGUAGES);
+        int fullCorrect = 0;
+        int int8Correct = 0;
+        int agree = 0;
+        int totalTests = 0;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+                continue;
+            }
+            std::string filename = entry.path().filename().string();
+            std::optional<Lang> language = LanguageCodes::fromCode(std::string_view(filename).substr(0, 2));
+            if (!language) {
+                continue;
+            }
+            size_t expected = LanguageCodes::index(*language);
+
+            for (const std::string& text : readWordsFromFile(entry.path().string())) {
+                std::fill(full.begin(), full.end(), 0.0);
+                std::fill(quantized.begin(), quantized.end(), 0);
+                uint32_t numFeatures = 0;
+
+                LanguageDetector::emitBuckets(text, [&](uint32_t bucket) {
+                    numFeatures++;
+                    for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                        full[i] += WEIGHTS[bucket * NUM_LANGUAGES + i];
+                        quantized[i] += model.weights[bucket * NUM_LANGUAGES + i];
+                    }
+                });
+                if (numFeatures == 0) {
+                    continue;
+                }
+                double norm = 1.0 / std::sqrt(static_cast<double>(numFeatures));
+
+                for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                    scores[i] = full[i] * norm + INTERCEPTS[i];
+                }
+                size_t fullPrediction = argmax(scores);
+                for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                    scores[i] = quantized[i] * static_cast<double>(model.scales[i]) * norm + INTERCEPTS[i];
+                }
+                size_t prediction = argmax(scores);
+
+                fullCorrect += (fullPrediction == expected);
+                int8Correct += (prediction == expected);
+                agree += (prediction == fullPrediction);
+                totalTests++;
+            }
+        }
+
+        std::cout << "\nACCURACY (" << totalTests << " texts)\n";
+        std::cout << std::string(50, '-') << "\n";
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::setw(10) << "float" << std::setw(13)
+                  << (totalTests > 0 ? 100.0 * fullCorrect / totalTests : 0.0) << "%\n";
+        std::cout << std::setw(10) << "int8" << std::setw(13)
+                  << (totalTests > 0 ? 100.0 * int8Correct / totalTests : 0.0) << "%"
+                  << "   agreement w/ float " << (totalTests > 0 ? 100.0 * agree / totalTests : 0.0) << "%\n";
+
+        evaluation << "Accuracy on " << dataDirectory << " (" << totalTests << " texts): " << std::fixed
+                   << std::setprecision(2) << (totalTests > 0 ? 100.0 * int8Correct / totalTests : 0.0)
+                   << "% (float " << (totalTests > 0 ? 100.0 * fullCorrect / totalTests : 0.0)
+                   << "%), agreement with float " << (totalTests > 0 ? 100.0 * agree / totalTests : 0.0) << "%";
+    } else {
+        std::cout << "\nData directory " << dataDirectory << " not found, skipping accuracy report\n";
+        evaluation << "Not evaluated: " << dataDirectory << " not found";
+    }
+
+    try {
+        exportModel(outputFile, int8, model, commandLine(argc, argv), evaluation.str());
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "\nModel exported to " << outputFile << "\n";
+
+    return 0;
+}
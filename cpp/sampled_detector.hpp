@@ -0,0 +1,149 @@
+#ifndef SAMPLED_DETECTOR_HPP
+#define SAMPLED_DETECTOR_HPP
+
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "partial_score.hpp"
+
+struct TextWindow {
+    size_t begin;  // byte offsets into the text, [begin, end)
+    size_t end;
+    LanguageDetector::TokenizerState state;  // tokenizer state at `begin`
+};
+
+// Scores a long document from K windows instead of every byte.
+//
+// Windows are placed at evenly spaced offsets (the first at the head, the last
+// at the tail) or at one random offset per stratum of text.size() / K bytes.
+// Each window start moves forward to a tokenizer split point if one is near,
+// which reproduces the full-scan features, and otherwise to the byte after a
+// whitespace or at least to a code point boundary. Each window end moves back
+// past the last whitespace so no word is cut. The windows are tokenized with
+// the existing tokenizer into one score sum. A text no longer than the K
+// windows together is scored whole. The window list is allocated from `memory`.
+class SampledDetector {
+public:
+    enum class Placement {
+        Even,
+        Stratified
+    };
+
+    static constexpr size_t DEFAULT_NUM_WINDOWS = 16;
+    static constexpr size_t DEFAULT_WINDOW_SIZE = 512;
+
+    static Lang detectLanguage(std::string_view text, size_t numWindows = DEFAULT_NUM_WINDOWS,
+                               size_t windowSize = DEFAULT_WINDOW_SIZE, Placement placement = Placement::Even,
+                               uint64_t seed = 0, std::pmr::memory_resource* memory = std::pmr::get_default_resource()) {
+        PartialScore partial;
+        for (const TextWindow& window : placeWindows(text, numWindows, windowSize, placement, seed, memory)) {
+            LanguageDetector::TokenizerState state = window.state;
+            LanguageDetector::emitBuckets(text.data() + window.begin, window.end - window.begin, state,
+                                          [&](uint32_t bucket) {
+                partial.numFeatures++;
+                LanguageDetector::addBucket(partial.scores, bucket);
+            });
+        }
+        return partial.finalize();
+    }
+
+    // Windows that detectLanguage scores, in text order and without overlap.
+    // Their total length is at most numWindows * windowSize.
+    static std::pmr::vector<TextWindow> placeWindows(std::string_view text, size_t numWindows, size_t windowSize,
+                                                     Placement placement = Placement::Even, uint64_t seed = 0,
+                                                     std::pmr::memory_resource* memory =
+                                                         std::pmr::get_default_resource()) {
+        std::pmr::vector<TextWindow> windows(memory);
+        numWindows = std::max<size_t>(numWindows, 1);
+        if (windowSize >= text.size() || numWindows * windowSize >= text.size()) {
+            windows.push_back({0, text.size(), LanguageDetector::TokenizerState()});
+            return windows;
+        }
+        if (windowSize == 0) {
+            return windows;
+        }
+
+        size_t span = text.size() - windowSize;  // last possible window start
+        uint64_t random = seed;
+        for (size_t w = 0; w < numWindows; ++w) {
+            size_t offset;
+            if (placement == Placement::Even) {
+                offset = numWindows == 1 ? 0 : span * w / (numWindows - 1);
+            } else {
+                size_t lo = text.size() / numWindows * w;
+                size_t hi = std::max(lo, std::min(span, text.size() / numWindows * (w + 1) - windowSize));
+                offset = lo + nextRandom(random) % (hi - lo + 1);
+            }
+
+            TextWindow window = alignWindow(text, offset, windowSize);
+            if (!windows.empty() && window.begin <= windows.back().end) {
+                // Overlapping windows are scored as one
+                windows.back().end = std::max(windows.back().end, window.end);
+                continue;
+            }
+            if (window.begin < window.end) {
+                windows.push_back(window);
+            }
+        }
+        return windows;
+    }
+
+private:
+    static constexpr size_t ALIGN_SLACK = 64;  // how far a window start may move forward
+
+    static bool isWhitespace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+    static bool isContinuationByte(char c) {
+        return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+    }
+
+    static TextWindow alignWindow(std::string_view text, size_t offset, size_t windowSize) {
+        TextWindow window{offset, offset, LanguageDetector::TokenizerState()};
+        size_t limit = std::min(offset + ALIGN_SLACK, text.size());
+
+        if (offset > 0) {
+            size_t split = LanguageDetector::findSplitPoint(text.data(), text.size(), offset, limit, window.state);
+            if (split < limit) {
+                window.begin = split;
+            } else {
+                window.state = LanguageDetector::TokenizerState();
+                size_t space = offset;
+                while (space < limit && !isWhitespace(text[space])) {
+                    space++;
+                }
+                window.begin = space < limit ? space + 1 : offset;
+                while (window.begin < text.size() && isContinuationByte(text[window.begin])) {
+                    window.begin++;
+                }
+            }
+        }
+
+        window.end = std::min(window.begin + windowSize, text.size());
+        if (window.end < text.size()) {
+            size_t space = window.end;
+            while (space > window.begin + windowSize / 2 && !isWhitespace(text[space - 1])) {
+                space--;
+            }
+            if (space > window.begin + windowSize / 2) {
+                window.end = space;
+            } else {
+                while (window.end > window.begin && isContinuationByte(text[window.end])) {
+                    window.end--;
+                }
+            }
+        }
+        return window;
+    }
+
+    // splitmix64, so stratified placement is reproducible for a given seed
+    static uint64_t nextRandom(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+};
+
+#endif // SAMPLED_DETECTOR_HPP
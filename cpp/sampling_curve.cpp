@@ -0,0 +1,154 @@
+// Accuracy against bytes read for SampledDetector.
+//
+// Concatenates the lingua test sentences of each language into long documents, then
+// scores every document with a full scan and with K sampled windows for a range of
+// K and window sizes. Reports how often the sampled answer equals the full scan,
+// how often it is correct and the share of bytes read, and the smallest K that
+// matches the full scan on at least 99.9% of the documents.
+//
+// Build:
+//   g++ -std=c++17 -O2 sampling_curve.cpp -o sampling_curve
+// Run:
+//   ./sampling_curve [data_dir] [document_bytes]
+#include "sampled_detector.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <iomanip>
+
+// Helper function to trim whitespace from a string
+std::string trim(const std::string& str) {
+    size_t start = str.find_first_not_of(" \t\n\r");
+    if (start == std::string::npos) return "";
+    size_t end = str.find_last_not_of(" \t\n\r");
+    return str.substr(start, end - start + 1);
+}
+
+std::vector<std::string> readWordsFromFile(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filepath);
+    }
+
+    std::vector<std::string> words;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string word = trim(line);
+        if (!word.empty()) {
+            words.push_back(word);
+        }
+    }
+
+    return words;
+}
+
+struct Document {
+    std::string text;
+    std::string expectedLang;  // language code from the file name
+    Lang fullScan;
+};
+
+int main(int argc, char* argv[]) {
+    std::string dataDirectory = "../lingua/language-testdata/sentences"; // Default directory
+    size_t documentBytes = 64 * 1024;
+
+    if (argc > 1) {
+        dataDirectory = argv[1];
+    }
+    if (argc > 2) {
+        documentBytes = std::stoul(argv[2]);
+    }
+
+    std::vector<Document> documents;
+    size_t totalBytes = 0;
+
+    try {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
+            if (!entry.is_regular_file() || entry.path().extension() != ".txt") {
+                continue;
+            }
+            std::string expectedLang = entry.path().filename().string().substr(0, 2);
+
+            std::string text;
+            for (const std::string& sentence : readWordsFromFile(entry.path().string())) {
+                text += sentence;
+                text += ' ';
+                if (text.size() >= documentBytes) {
+                    documents.push_back({text, expectedLang, LanguageDetector::detectLanguage(text)});
+                    totalBytes += text.size();
+                    text.clear();
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        std::cerr << "Make sure the data directory exists and contains .txt files\n";
+        return 1;
+    }
+
+    if (documents.empty()) {
+        std::cerr << "No document of " << documentBytes << " bytes could be built from " << dataDirectory << "\n";
+        return 1;
+    }
+
+    int fullCorrect = 0;
+    for (const Document& document : documents) {
+        fullCorrect += three_letter_code(document.fullScan) == document.expectedLang;
+    }
+    std::cout << documents.size() << " documents of about " << documentBytes << " bytes\n";
+    std::cout << "Full scan accuracy: " << std::fixed << std::setprecision(2)
+              << 100.0 * fullCorrect / documents.size() << "%\n\n";
+
+    const std::pair<SampledDetector::Placement, const char*> placements[] = {
+        {SampledDetector::Placement::Even, "even"},
+        {SampledDetector::Placement::Stratified, "stratified"}
+    };
+
+    for (const auto& [placement, placementName] : placements) {
+        std::cout << "PLACEMENT: " << placementName << "\n";
+        std::cout << std::string(70, '-') << "\n";
+        std::cout << std::setw(8) << "Window" << std::setw(6) << "K" << std::setw(14) << "Bytes read"
+                  << std::setw(18) << "Same as full" << std::setw(14) << "Accuracy" << "\n";
+        std::cout << std::string(70, '-') << "\n";
+
+        for (size_t windowSize : {128, 256, 512, 1024}) {
+            size_t smallestK = 0;
+            for (size_t numWindows : {1, 2, 4, 8, 16, 32, 64, 128}) {
+                size_t bytesRead = 0;
+                int agree = 0;
+                int correct = 0;
+
+                for (size_t d = 0; d < documents.size(); ++d) {
+                    const Document& document = documents[d];
+                    for (const TextWindow& window : SampledDetector::placeWindows(document.text, numWindows,
+                                                                                  windowSize, placement, d)) {
+                        bytesRead += window.end - window.begin;
+                    }
+                    Lang sampled = SampledDetector::detectLanguage(document.text, numWindows, windowSize,
+                                                                   placement, d);
+                    agree += sampled == document.fullScan;
+                    correct += three_letter_code(sampled) == document.expectedLang;
+                }
+
+                double agreement = 100.0 * agree / documents.size();
+                if (smallestK == 0 && agreement >= 99.9) {
+                    smallestK = numWindows;
+                }
+                std::cout << std::setw(8) << windowSize << std::setw(6) << numWindows
+                          << std::setw(13) << std::setprecision(2) << 100.0 * bytesRead / totalBytes << "%"
+                          << std::setw(17) << agreement << "%"
+                          << std::setw(13) << 100.0 * correct / documents.size() << "%\n";
+            }
+            std::cout << "Smallest K with >= 99.9% agreement at window " << windowSize << ": ";
+            if (smallestK > 0) {
+                std::cout << smallestK << "\n\n";
+            } else {
+                std::cout << "none up to 128\n\n";
+            }
+        }
+    }
+
+    return 0;
+}
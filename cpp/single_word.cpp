@@ -1,94 +1,57 @@
 #include "language_detector.hpp"
+#include "language_codes.hpp"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <string>
 #include <map>
+#include <memory_resource>
+#include <cstring>
 #include <vector>
 #include <iomanip>
 #include <sstream>
 
-// Map language codes to Lang enum values
-std::map<std::string, Lang> createLanguageMap() {
-    return {
-        {"af", Lang::Af}, {"ar", Lang::Ar}, {"az", Lang::Az}, {"be", Lang::Be},
-        {"bg", Lang::Bg}, {"bn", Lang::Bn}, {"bs", Lang::Bs}, {"ca", Lang::Ca},
-        {"cs", Lang::Cs}, {"cy", Lang::Cy}, {"da", Lang::Da}, {"de", Lang::De},
-        {"el", Lang::El}, {"en", Lang::En}, {"eo", Lang::Eo}, {"es", Lang::Es},
-        {"et", Lang::Et}, {"eu", Lang::Eu}, {"fa", Lang::Fa}, {"fi", Lang::Fi},
-        {"fr", Lang::Fr}, {"ga", Lang::Ga}, {"gu", Lang::Gu}, {"he", Lang::He},
-        {"hi", Lang::Hi}, {"hr", Lang::Hr}, {"hu", Lang::Hu}, {"hy", Lang::Hy},
-        {"id", Lang::Id}, {"is", Lang::Is}, {"it", Lang::It}, {"ja", Lang::Ja},
-        {"ka", Lang::Ka}, {"kk", Lang::Kk}, {"ko", Lang::Ko}, {"la", Lang::La},
-        {"lg", Lang::Lg}, {"lt", Lang::Lt}, {"lv", Lang::Lv}, {"mi", Lang::Mi},
-        {"mk", Lang::Mk}, {"mn", Lang::Mn}, {"mr", Lang::Mr}, {"ms", Lang::Ms},
-        {"nb", Lang::Nb}, {"nl", Lang::Nl}, {"nn", Lang::Nn}, {"pa", Lang::Pa},
-        {"pl", Lang::Pl}, {"pt", Lang::Pt}, {"ro", Lang::Ro}, {"ru", Lang::Ru},
-        {"sk", Lang::Sk}, {"sl", Lang::Sl}, {"sn", Lang::Sn}, {"so", Lang::So},
-        {"sq", Lang::Sq}, {"sr", Lang::Sr}, {"st", Lang::St}, {"sv", Lang::Sv},
-        {"sw", Lang::Sw}, {"ta", Lang::Ta}, {"te", Lang::Te}, {"th", Lang::Th},
-        {"tl", Lang::Tl}, {"tn", Lang::Tn}, {"tr", Lang::Tr}, {"ts", Lang::Ts},
-        {"uk", Lang::Uk}, {"ur", Lang::Ur}, {"vi", Lang::Vi}, {"xh", Lang::Xh},
-        {"yo", Lang::Yo}, {"zh", Lang::Zh}, {"zu", Lang::Zu}
-    };
-}
-
-// Map Lang enum back to string for output
-std::map<Lang, std::string> createReverseLanguageMap() {
-    return {
-        {Lang::Af, "af"}, {Lang::Ar, "ar"}, {Lang::Az, "az"}, {Lang::Be, "be"},
-        {Lang::Bg, "bg"}, {Lang::Bn, "bn"}, {Lang::Bs, "bs"}, {Lang::Ca, "ca"},
-        {Lang::Cs, "cs"}, {Lang::Cy, "cy"}, {Lang::Da, "da"}, {Lang::De, "de"},
-        {Lang::El, "el"}, {Lang::En, "en"}, {Lang::Eo, "eo"}, {Lang::Es, "es"},
-        {Lang::Et, "et"}, {Lang::Eu, "eu"}, {Lang::Fa, "fa"}, {Lang::Fi, "fi"},
-        {Lang::Fr, "fr"}, {Lang::Ga, "ga"}, {Lang::Gu, "gu"}, {Lang::He, "he"},
-        {Lang::Hi, "hi"}, {Lang::Hr, "hr"}, {Lang::Hu, "hu"}, {Lang::Hy, "hy"},
-        {Lang::Id, "id"}, {Lang::Is, "is"}, {Lang::It, "it"}, {Lang::Ja, "ja"},
-        {Lang::Ka, "ka"}, {Lang::Kk, "kk"}, {Lang::Ko, "ko"}, {Lang::La, "la"},
-        {Lang::Lg, "lg"}, {Lang::Lt, "lt"}, {Lang::Lv, "lv"}, {Lang::Mi, "mi"},
-        {Lang::Mk, "mk"}, {Lang::Mn, "mn"}, {Lang::Mr, "mr"}, {Lang::Ms, "ms"},
-        {Lang::Nb, "nb"}, {Lang::Nl, "nl"}, {Lang::Nn, "nn"}, {Lang::Pa, "pa"},
-        {Lang::Pl, "pl"}, {Lang::Pt, "pt"}, {Lang::Ro, "ro"}, {Lang::Ru, "ru"},
-        {Lang::Sk, "sk"}, {Lang::Sl, "sl"}, {Lang::Sn, "sn"}, {Lang::So, "so"},
-        {Lang::Sq, "sq"}, {Lang::Sr, "sr"}, {Lang::St, "st"}, {Lang::Sv, "sv"},
-        {Lang::Sw, "sw"}, {Lang::Ta, "ta"}, {Lang::Te, "te"}, {Lang::Th, "th"},
-        {Lang::Tl, "tl"}, {Lang::Tn, "tn"}, {Lang::Tr, "tr"}, {Lang::Ts, "ts"},
-        {Lang::Uk, "uk"}, {Lang::Ur, "ur"}, {Lang::Vi, "vi"}, {Lang::Xh, "xh"},
-        {Lang::Yo, "yo"}, {Lang::Zh, "zh"}, {Lang::Zu, "zu"}
-    };
-}
-
 // Helper function to trim whitespace from a string
-std::string trim(const std::string& str) {
+std::string_view trim(std::string_view str) {
     size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) return "";
+    if (start == std::string_view::npos) return "";
     size_t end = str.find_last_not_of(" \t\n\r");
     return str.substr(start, end - start + 1);
 }
 
-std::vector<std::string> readWordsFromFile(const std::string& filepath) {
+// Copies `text` into `arena`; the view stays valid until the arena is released
+std::string_view copyToArena(std::string_view text, std::pmr::memory_resource* arena) {
+    char* copy = static_cast<char*>(arena->allocate(text.size() + 1, 1));
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return std::string_view(copy, text.size());
+}
+
+// Words and the vector holding them are allocated from `arena`
+std::pmr::vector<std::string_view> readWordsFromFile(const std::string& filepath, std::pmr::memory_resource* arena) {
     std::ifstream file(filepath);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open file: " + filepath);
     }
     
-    std::vector<std::string> words;
-    std::string line;
+    std::pmr::vector<std::string_view> words(arena);
+    std::pmr::string line(arena);
     while (std::getline(file, line)) {
-        std::string word = trim(line);
+        std::string_view word = trim(line);
         if (!word.empty()) {
-            words.push_back(word);
+            words.push_back(copyToArena(word, arena));
         }
     }
     
     return words;
 }
 
+// Views into the run's arena or the static language code table
 struct TestResult {
-    std::string expectedLang;
-    std::string detectedLang;
-    std::string word;
-    std::string filename;
+    std::string_view expectedLang;
+    std::string_view detectedLang;
+    std::string_view word;
+    std::string_view filename;
     int lineNumber;
     bool correct;
 };
@@ -100,15 +63,16 @@ int main(int argc, char* argv[]) {
         dataDirectory = argv[1];
     }
     
-    auto langMap = createLanguageMap();
-    auto reverseLangMap = createReverseLanguageMap();
+    // Everything the run keeps (words, results, statistics) comes from one arena,
+    // released at once when main returns
+    std::pmr::monotonic_buffer_resource arena;
     
-    std::vector<TestResult> results;
+    std::pmr::vector<TestResult> results(&arena);
     int totalTests = 0;
     int correctPredictions = 0;
     
-    std::map<std::string, int> languageCorrect;
-    std::map<std::string, int> languageTotal;
+    std::pmr::map<std::string_view, int> languageCorrect(&arena);
+    std::pmr::map<std::string_view, int> languageTotal(&arena);
     
     std::cout << "Testing language detection accuracy on individual words...\n";
     std::cout << "Data directory: " << dataDirectory << "\n\n";
@@ -117,29 +81,29 @@ int main(int argc, char* argv[]) {
         // Iterate through all .txt files in the directory
         for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
             if (entry.is_regular_file() && entry.path().extension() == ".txt") {
-                std::string filename = entry.path().filename().string();
+                std::string_view filename = copyToArena(entry.path().filename().string(), &arena);
                 std::string filepath = entry.path().string();
                 
                 // Extract language code from filename (first 2 characters)
                 if (filename.length() >= 2) {
-                    std::string expectedLangCode = filename.substr(0, 2);
+                    std::string_view expectedLangCode = filename.substr(0, 2);
                     
                     // Check if this language code is supported
-                    if (langMap.find(expectedLangCode) != langMap.end()) {
+                    if (LanguageCodes::fromCode(expectedLangCode)) {
                         try {
                             // Read all words from file
-                            std::vector<std::string> words = readWordsFromFile(filepath);
+                            std::pmr::vector<std::string_view> words = readWordsFromFile(filepath, &arena);
                             
                             std::cout << "Processing " << filename << " (" << words.size() << " words)...\n";
                             
                             // Test each word individually
                             for (size_t i = 0; i < words.size(); ++i) {
-                                const std::string& word = words[i];
+                                std::string_view word = words[i];
                                 
                                 try {
                                     // Detect language for this word
                                     Lang detectedLang = LanguageDetector::detectLanguage(word);
-                                    std::string detectedLangCode = reverseLangMap[detectedLang];
+                                    std::string_view detectedLangCode = LanguageCodes::code(detectedLang);
                                     
                                     // Check if prediction is correct
                                     bool isCorrect = (expectedLangCode == detectedLangCode);
@@ -200,7 +164,7 @@ int main(int argc, char* argv[]) {
         std::cout << std::string(70, '-') << "\n";
         
         for (const auto& pair : languageTotal) {
-            std::string lang = pair.first;
+            std::string_view lang = pair.first;
             int total = pair.second;
             int correct = languageCorrect[lang];
             double accuracy = total > 0 ? (100.0 * correct / total) : 0.0;
@@ -235,7 +199,7 @@ int main(int argc, char* argv[]) {
         std::cout << "\nMOST COMMON CONFUSIONS:\n";
         std::cout << std::string(70, '-') << "\n";
         
-        std::map<std::pair<std::string, std::string>, int> confusions;
+        std::pmr::map<std::pair<std::string_view, std::string_view>, int> confusions(&arena);
         for (const auto& result : results) {
             if (!result.correct) {
                 confusions[{result.expectedLang, result.detectedLang}]++;
@@ -243,8 +207,8 @@ int main(int argc, char* argv[]) {
         }
         
         // Sort confusions by count
-        std::vector<std::pair<std::pair<std::string, std::string>, int>> sortedConfusions(
-            confusions.begin(), confusions.end());
+        std::pmr::vector<std::pair<std::pair<std::string_view, std::string_view>, int>> sortedConfusions(
+            confusions.begin(), confusions.end(), &arena);
         std::sort(sortedConfusions.begin(), sortedConfusions.end(),
                   [](const auto& a, const auto& b) { return a.second > b.second; });
         
@@ -0,0 +1,123 @@
+#include "multi_model_detector.hpp"
+#include "language_codes.hpp"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <memory_resource>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <iomanip>
+
+// Helper function to trim whitespace from a string
+std::string_view trim(std::string_view str) {
+    size_t start = str.find_first_not_of(" \t\n\r");
+    if (start == std::string_view::npos) return "";
+    size_t end = str.find_last_not_of(" \t\n\r");
+    return str.substr(start, end - start + 1);
+}
+
+// Copies `text` into `arena`; the view stays valid until the arena is released
+std::string_view copyToArena(std::string_view text, std::pmr::memory_resource* arena) {
+    char* copy = static_cast<char*>(arena->allocate(text.size() + 1, 1));
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return std::string_view(copy, text.size());
+}
+
+// Words and the vector holding them are allocated from `arena`
+std::pmr::vector<std::string_view> readWordsFromFile(const std::string& filepath, std::pmr::memory_resource* arena) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filepath);
+    }
+
+    std::pmr::vector<std::string_view> words(arena);
+    std::pmr::string line(arena);
+    while (std::getline(file, line)) {
+        std::string_view word = trim(line);
+        if (!word.empty()) {
+            words.push_back(copyToArena(word, arena));
+        }
+    }
+
+    return words;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dataDirectory = "../lingua/language-testdata/single-words"; // Default directory
+
+    if (argc > 1) {
+        dataDirectory = argv[1];
+    }
+
+    // Both models in one pass: the production model and the candidate trained with negatives
+    const std::array<LanguageModel, 2> models = {MODEL_PRIMARY, MODEL_NEG};
+    const std::array<std::string, 2> modelNames = {"weights_4096", "weights_neg"};
+
+    int totalTests = 0;
+    std::array<int, 2> modelCorrect = {};
+    int ensembleCorrect = 0;
+    int disagreements = 0;
+
+    std::cout << "Scoring " << modelNames[0] << " and " << modelNames[1] << " in a single pass...\n";
+    std::cout << "Data directory: " << dataDirectory << "\n\n";
+
+    try {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".txt") {
+                std::string filename = entry.path().filename().string();
+
+                std::optional<Lang> language = LanguageCodes::fromCode(std::string_view(filename).substr(0, 2));
+                if (!language) {
+                    continue;
+                }
+                Lang expected = *language;
+
+                // One arena per file, released at once after it is scored
+                std::pmr::monotonic_buffer_resource fileArena;
+                std::pmr::vector<std::string_view> words = readWordsFromFile(entry.path().string(), &fileArena);
+                std::cout << "Processing " << filename << " (" << words.size() << " words)...\n";
+
+                for (std::string_view word : words) {
+                    MultiModelResult<2> result = MultiModelDetector::detectLanguages(word, models);
+
+                    totalTests++;
+                    for (size_t m = 0; m < models.size(); ++m) {
+                        if (result.languages[m] == expected) {
+                            modelCorrect[m]++;
+                        }
+                    }
+                    if (result.ensemble == expected) {
+                        ensembleCorrect++;
+                    }
+                    if (result.languages[0] != result.languages[1]) {
+                        disagreements++;
+                    }
+                }
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        std::cerr << "Make sure the data directory exists and contains .txt files\n";
+        std::cerr << "with filenames starting with 2-letter language codes.\n";
+        return 1;
+    }
+
+    auto percent = [&](int count) {
+        return totalTests > 0 ? (100.0 * count / totalTests) : 0.0;
+    };
+
+    std::cout << "\n" << std::string(70, '=') << "\n";
+    std::cout << "OVERALL RESULTS\n";
+    std::cout << std::string(70, '=') << "\n";
+    std::cout << "Total word tests: " << totalTests << "\n";
+    for (size_t m = 0; m < models.size(); ++m) {
+        std::cout << std::setw(16) << modelNames[m] << " accuracy: " << std::fixed << std::setprecision(2)
+                  << percent(modelCorrect[m]) << "%\n";
+    }
+    std::cout << std::setw(16) << "ensemble" << " accuracy: " << percent(ensembleCorrect) << "%\n";
+    std::cout << "Models disagree on " << disagreements << " words (" << percent(disagreements) << "%)\n";
+
+    return 0;
+}
@@ -1,68 +1,57 @@
 #include "language_detector_g.hpp"
+#include "language_codes.hpp"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
 #include <string>
 #include <map>
+#include <memory_resource>
+#include <cstring>
 #include <vector>
 #include <iomanip>
 #include <sstream>
 
-// Map language codes to Lang enum values - only 6 languages
-std::map<std::string, Lang> createLanguageMap() {
-    return {
-        {"de", Lang::De},
-        {"en", Lang::En},
-        {"fr", Lang::Fr},
-        {"es", Lang::Es},
-        {"ja", Lang::Ja},
-        {"zh", Lang::Zh}
-    };
-}
-
-// Map Lang enum back to string for output - only 6 languages
-std::map<Lang, std::string> createReverseLanguageMap() {
-    return {
-        {Lang::De, "de"},
-        {Lang::En, "en"},
-        {Lang::Fr, "fr"},
-        {Lang::Es, "es"},
-        {Lang::Ja, "ja"},
-        {Lang::Zh, "zh"}
-    };
-}
-
 // Helper function to trim whitespace from a string
-std::string trim(const std::string& str) {
+std::string_view trim(std::string_view str) {
     size_t start = str.find_first_not_of(" \t\n\r");
-    if (start == std::string::npos) return "";
+    if (start == std::string_view::npos) return "";
     size_t end = str.find_last_not_of(" \t\n\r");
     return str.substr(start, end - start + 1);
 }
 
-std::vector<std::string> readWordsFromFile(const std::string& filepath) {
+// Copies `text` into `arena`; the view stays valid until the arena is released
+std::string_view copyToArena(std::string_view text, std::pmr::memory_resource* arena) {
+    char* copy = static_cast<char*>(arena->allocate(text.size() + 1, 1));
+    std::memcpy(copy, text.data(), text.size());
+    copy[text.size()] = '\0';
+    return std::string_view(copy, text.size());
+}
+
+// Words and the vector holding them are allocated from `arena`
+std::pmr::vector<std::string_view> readWordsFromFile(const std::string& filepath, std::pmr::memory_resource* arena) {
     std::ifstream file(filepath);
     if (!file.is_open()) {
         throw std::runtime_error("Cannot open file: " + filepath);
     }
     
-    std::vector<std::string> words;
-    std::string line;
+    std::pmr::vector<std::string_view> words(arena);
+    std::pmr::string line(arena);
     while (std::getline(file, line)) {
-        std::string word = trim(line);
+        std::string_view word = trim(line);
         if (!word.empty()) {
-            words.push_back(word);
+            words.push_back(copyToArena(word, arena));
         }
     }
     
     return words;
 }
 
+// Views into the run's arena or the static language code table
 struct TestResult {
-    std::string expectedLang;
-    std::string detectedLang;
-    std::string word;
-    std::string filename;
+    std::string_view expectedLang;
+    std::string_view detectedLang;
+    std::string_view word;
+    std::string_view filename;
     int lineNumber;
     bool correct;
 };
@@ -74,15 +63,16 @@ int main(int argc, char* argv[]) {
         dataDirectory = argv[1];
     }
     
-    auto langMap = createLanguageMap();
-    auto reverseLangMap = createReverseLanguageMap();
+    // Everything the run keeps (words, results, statistics) comes from one arena,
+    // released at once when main returns
+    std::pmr::monotonic_buffer_resource arena;
     
-    std::vector<TestResult> results;
+    std::pmr::vector<TestResult> results(&arena);
     int totalTests = 0;
     int correctPredictions = 0;
     
-    std::map<std::string, int> languageCorrect;
-    std::map<std::string, int> languageTotal;
+    std::pmr::map<std::string_view, int> languageCorrect(&arena);
+    std::pmr::map<std::string_view, int> languageTotal(&arena);
     
     std::cout << "Testing language detection accuracy on individual words...\n";
     std::cout << "Data directory: " << dataDirectory << "\n";
@@ -92,29 +82,29 @@ int main(int argc, char* argv[]) {
         // Iterate through all .txt files in the directory
         for (const auto& entry : std::filesystem::recursive_directory_iterator(dataDirectory)) {
             if (entry.is_regular_file() && entry.path().extension() == ".txt") {
-                std::string filename = entry.path().filename().string();
+                std::string_view filename = copyToArena(entry.path().filename().string(), &arena);
                 std::string filepath = entry.path().string();
                 
                 // Extract language code from filename (first 2 characters)
                 if (filename.length() >= 2) {
-                    std::string expectedLangCode = filename.substr(0, 2);
+                    std::string_view expectedLangCode = filename.substr(0, 2);
                     
                     // Check if this language code is supported (only process our 6 languages)
-                    if (langMap.find(expectedLangCode) != langMap.end()) {
+                    if (LanguageCodes::fromCode(expectedLangCode)) {
                         try {
                             // Read all words from file
-                            std::vector<std::string> words = readWordsFromFile(filepath);
+                            std::pmr::vector<std::string_view> words = readWordsFromFile(filepath, &arena);
                             
                             std::cout << "Processing " << filename << " (" << words.size() << " words)...\n";
                             
                             // Test each word individually
                             for (size_t i = 0; i < words.size(); ++i) {
-                                const std::string& word = words[i];
+                                std::string_view word = words[i];
                                 
                                 try {
                                     // Detect language for this word
                                     Lang detectedLang = LanguageDetector::detectLanguage(word);
-                                    std::string detectedLangCode = reverseLangMap[detectedLang];
+                                    std::string_view detectedLangCode = LanguageCodes::code(detectedLang);
                                     
                                     // Check if prediction is correct
                                     bool isCorrect = (expectedLangCode == detectedLangCode);
@@ -177,7 +167,7 @@ int main(int argc, char* argv[]) {
         std::cout << std::string(70, '-') << "\n";
         
         for (const auto& pair : languageTotal) {
-            std::string lang = pair.first;
+            std::string_view lang = pair.first;
             int total = pair.second;
             int correct = languageCorrect[lang];
             double accuracy = total > 0 ? (100.0 * correct / total) : 0.0;
@@ -212,7 +202,7 @@ int main(int argc, char* argv[]) {
         std::cout << "\nMOST COMMON CONFUSIONS:\n";
         std::cout << std::string(70, '-') << "\n";
         
-        std::map<std::pair<std::string, std::string>, int> confusions;
+        std::pmr::map<std::pair<std::string_view, std::string_view>, int> confusions(&arena);
         for (const auto& result : results) {
             if (!result.correct) {
                 confusions[{result.expectedLang, result.detectedLang}]++;
@@ -220,8 +210,8 @@ int main(int argc, char* argv[]) {
         }
         
         // Sort confusions by count
-        std::vector<std::pair<std::pair<std::string, std::string>, int>> sortedConfusions(
-            confusions.begin(), confusions.end());
+        std::pmr::vector<std::pair<std::pair<std::string_view, std::string_view>, int>> sortedConfusions(
+            confusions.begin(), confusions.end(), &arena);
         std::sort(sortedConfusions.begin(), sortedConfusions.end(),
                   [](const auto& a, const auto& b) { return a.second > b.second; });
         
@@ -0,0 +1,66 @@
+#ifndef STREAMING_DETECTOR_HPP
+#define STREAMING_DETECTOR_HPP
+
+#include <array>
+#include <string_view>
+#include "partial_score.hpp"
+
+// Incremental detector for input that arrives in chunks (log files, sockets).
+// Memory is constant: only the tokenizer state, a partial UTF-8 sequence of at
+// most 3 bytes, the running score sums and the feature count are kept between
+// chunks. result() matches LanguageDetector::detectLanguage on the concatenation
+// of all fed chunks.
+class StreamingDetector {
+public:
+    void feed(std::string_view chunk) {
+        auto accumulate = [this](uint32_t bucket) {
+            partial.numFeatures++;
+            LanguageDetector::addBucket(partial.scores, bucket);
+        };
+        size_t offset = 0;
+
+        if (pendingLength > 0) {
+            // Complete the sequence split by the previous chunk boundary
+            size_t needed = LanguageDetector::utf8SequenceLength(static_cast<unsigned char>(pending[0]));
+            while (pendingLength < needed && offset < chunk.size()) {
+                pending[pendingLength++] = chunk[offset++];
+            }
+            if (pendingLength < needed) {
+                return;
+            }
+            LanguageDetector::emitBuckets(pending.data(), pendingLength, state, accumulate);
+            pendingLength = 0;
+        }
+
+        const char* rest = chunk.data() + offset;
+        size_t restLength = chunk.size() - offset;
+        size_t consumed = LanguageDetector::emitBuckets(rest, restLength, state, accumulate);
+
+        for (size_t i = consumed; i < restLength; ++i) {
+            pending[pendingLength++] = rest[i];
+        }
+    }
+
+    // Language of everything fed so far. A sequence still cut off at the end is
+    // dropped, as the one-shot decoder does at the end of a text.
+    Lang result() const {
+        return partial.finalize();
+    }
+
+    // Accumulated sums so far, e.g. to merge with other streams of the same entity
+    const PartialScore& partialScore() const {
+        return partial;
+    }
+
+    void reset() {
+        *this = StreamingDetector();
+    }
+
+private:
+    LanguageDetector::TokenizerState state;
+    std::array<char, 4> pending{};
+    size_t pendingLength = 0;
+    PartialScore partial;
+};
+
+#endif // STREAMING_DETECTOR_HPP
@@ -0,0 +1,358 @@
+#ifndef TEXT_FILTER_HPP
+#define TEXT_FILTER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "language_detector.hpp"
+
+struct TextStats {
+    size_t bytes = 0;
+    size_t control = 0;        // C0 controls other than tab and line breaks, and DEL
+    size_t invalid = 0;        // bytes not part of a well-formed UTF-8 sequence
+    size_t whitespace = 0;
+    size_t asciiLetters = 0;
+    size_t digits = 0;
+    size_t symbols = 0;        // printable ASCII that is neither alphanumeric nor whitespace
+    size_t nonAscii = 0;       // well-formed multi-byte code points
+    size_t runs = 0;           // maximal runs of ASCII alphanumerics
+    size_t runBytes = 0;
+    size_t mixedRuns = 0;      // runs containing both letters and digits, e.g. hex or base64
+    size_t longestRun = 0;
+};
+
+enum class TextVerdict {
+    Text,
+    Empty,     // no letter at all, detectLanguage would fall back to English
+    Binary,    // control bytes or invalid UTF-8
+    Encoded,   // long or mixed letter/digit runs: base64, hex, hashes
+    Symbolic   // mostly digits and punctuation: tables, dumps, minified code
+};
+
+struct FilterConfig {
+    double maxControlRatio = 0.01;
+    double maxInvalidRatio = 0.01;
+    double minLetterRatio = 0.5;     // letters among non-whitespace bytes
+    double maxSymbolRatio = 0.25;    // ASCII punctuation among non-whitespace bytes
+    double maxMeanRunLength = 16.0;
+    double maxMixedRunRatio = 0.25;
+    size_t maxRunLength = 64;
+};
+
+// Cheap pre-pass that rejects input which is not natural language before any
+// scoring work is spent on it. measure() reads every byte once: printable ASCII
+// eight bytes at a time with word arithmetic, anything else with one table
+// lookup per byte; the UTF-8 check only runs on non-ASCII lead bytes.
+// classify() turns the counts into a verdict with the thresholds of FilterConfig.
+class TextFilter {
+public:
+    static TextStats measure(std::string_view text) {
+        TextStats stats;
+        stats.bytes = text.size();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(text.data());
+        size_t run = 0;
+        bool runHasLetter = false;
+        bool runHasDigit = false;
+
+        auto endRun = [&]() {
+            if (run > 0) {
+                stats.runs++;
+                stats.runBytes += run;
+                stats.mixedRuns += runHasLetter && runHasDigit;
+                stats.longestRun = std::max(stats.longestRun, run);
+            }
+            run = 0;
+            runHasLetter = false;
+            runHasDigit = false;
+        };
+
+        // Printable ASCII goes eight bytes at a time: the byte classes come from
+        // range tests on the whole word and its runs from BIT_RUNS, where the low
+        // run extends the current run and the high one starts the next. Only inner
+        // runs holding letters and digits are walked one by one. After a word with
+        // other bytes, the next eight bytes go through the table.
+        size_t scalarEnd = 0;
+        for (size_t i = 0; i < text.size();) {
+            uint64_t letters, digits, spaces;
+            if (i >= scalarEnd) {
+                while (i + 8 <= text.size() && printableWord(bytes + i, letters, digits, spaces)) {
+                    unsigned letterBits = packBytes(letters);
+                    unsigned digitBits = packBytes(digits);
+                    unsigned alphanumeric = letterBits | digitBits;
+                    size_t numLetters = BIT_RUNS[letterBits].ones;
+                    size_t numDigits = BIT_RUNS[digitBits].ones;
+                    size_t numSpaces = countBytes(spaces);
+                    stats.asciiLetters += numLetters;
+                    stats.digits += numDigits;
+                    stats.whitespace += numSpaces;
+                    stats.symbols += 8 - numLetters - numDigits - numSpaces;
+
+                    const BitRuns& runs = BIT_RUNS[alphanumeric];
+                    unsigned lowBits = (1u << runs.low) - 1;
+                    unsigned highBits = 0xFF & ~(0xFFu >> runs.high);
+                    unsigned innerBits = alphanumeric & ~lowBits & ~highBits;
+                    run += runs.low;
+                    runHasLetter |= (letterBits & lowBits) != 0;
+                    runHasDigit |= (digitBits & lowBits) != 0;
+
+                    // Without branches: a word of eight alphanumerics has no inner
+                    // or high run and only extends the current run
+                    bool ends = runs.low < 8;
+                    size_t ended = ends ? run : 0;
+                    stats.runs += (ended > 0) + runs.inner;
+                    stats.runBytes += ended + runs.innerOnes;
+                    stats.mixedRuns += ends & runHasLetter & runHasDigit;
+                    stats.longestRun = std::max({stats.longestRun, ended, size_t{runs.longestInner}});
+                    if ((letterBits & innerBits) != 0 && (digitBits & innerBits) != 0) {
+                        for (unsigned k = runs.low; k < 8;) {
+                            unsigned length = BIT_RUNS[innerBits >> k].low;
+                            unsigned runBits = ((1u << length) - 1) << k;
+                            stats.mixedRuns += (letterBits & runBits) != 0 && (digitBits & runBits) != 0;
+                            k += length + 1;
+                        }
+                    }
+                    run = ends ? runs.high : run;
+                    runHasLetter = ends ? (letterBits & highBits) != 0 : runHasLetter;
+                    runHasDigit = ends ? (digitBits & highBits) != 0 : runHasDigit;
+                    i += 8;
+                }
+                scalarEnd = i + 8;
+                if (i == text.size()) {
+                    break;
+                }
+            }
+            unsigned char c = bytes[i];
+            switch (BYTE_CLASSES[c]) {
+                case Letter:
+                    stats.asciiLetters++;
+                    run++;
+                    runHasLetter = true;
+                    i++;
+                    continue;
+                case Digit:
+                    stats.digits++;
+                    run++;
+                    runHasDigit = true;
+                    i++;
+                    continue;
+                case Whitespace:
+                    stats.whitespace++;
+                    break;
+                case Symbol:
+                    stats.symbols++;
+                    break;
+                case Control:
+                    stats.control++;
+                    break;
+                case Lead: {
+                    size_t length = validSequenceLength(bytes, text.size(), i);
+                    if (length > 0) {
+                        stats.nonAscii++;
+                        endRun();
+                        i += length;
+                        continue;
+                    }
+                    stats.invalid++;
+                    break;
+                }
+                case Invalid:
+                    stats.invalid++;
+                    break;
+            }
+            endRun();
+            i++;
+        }
+        endRun();
+
+        return stats;
+    }
+
+    static TextVerdict classify(const TextStats& stats, const FilterConfig& config = FilterConfig()) {
+        if (stats.asciiLetters + stats.nonAscii == 0) {
+            return TextVerdict::Empty;
+        }
+        double bytes = static_cast<double>(stats.bytes);
+        if (stats.control > config.maxControlRatio * bytes || stats.invalid > config.maxInvalidRatio * bytes) {
+            return TextVerdict::Binary;
+        }
+
+        // Letters against everything printed; a non-ASCII code point counts as
+        // one letter and one byte
+        double printed = static_cast<double>(stats.asciiLetters + stats.digits + stats.symbols + stats.nonAscii);
+        if (stats.asciiLetters + stats.nonAscii < config.minLetterRatio * printed
+            || stats.symbols > config.maxSymbolRatio * printed) {
+            return TextVerdict::Symbolic;
+        }
+        if (stats.runs > 0) {
+            double runs = static_cast<double>(stats.runs);
+            if (stats.longestRun > config.maxRunLength || stats.runBytes > config.maxMeanRunLength * runs
+                || stats.mixedRuns > config.maxMixedRunRatio * runs) {
+                return TextVerdict::Encoded;
+            }
+        }
+        return TextVerdict::Text;
+    }
+
+    static TextVerdict classify(std::string_view text, const FilterConfig& config = FilterConfig()) {
+        return classify(measure(text), config);
+    }
+
+    // detectLanguage behind the pre-pass: returns no language (Unknown) for
+    // rejected input instead of a guess
+    static std::optional<Lang> detectLanguage(std::string_view text, const FilterConfig& config = FilterConfig()) {
+        if (classify(text, config) != TextVerdict::Text) {
+            return std::nullopt;
+        }
+        return LanguageDetector::detectLanguage(text);
+    }
+
+    static constexpr std::string_view languageCode(std::optional<Lang> language) {
+        return language ? three_letter_code(*language) : "unknown";
+    }
+
+private:
+    enum ByteClass : uint8_t {
+        Letter,
+        Digit,
+        Whitespace,
+        Symbol,
+        Control,
+        Lead,     // starts a multi-byte sequence
+        Invalid   // continuation byte on its own, or never valid in UTF-8
+    };
+
+    static constexpr uint64_t ONES = 0x0101010101010101ull;
+    static constexpr uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+    // High bit of each byte of `word` whose value is at least `bound`, for words
+    // without a byte >= 0x80: adding 0x80 - bound cannot carry into the next byte
+    static constexpr uint64_t atLeast(uint64_t word, uint8_t bound) {
+        return (word + (0x80 - bound) * ONES) & HIGH_BITS;
+    }
+
+    // Number of bytes of a high-bit mask
+    static constexpr size_t countBytes(uint64_t mask) {
+        return static_cast<size_t>(((mask >> 7) * ONES) >> 56);
+    }
+
+    // High-bit mask to one bit per byte, bit k for the byte at offset k
+    static constexpr unsigned packBytes(uint64_t mask) {
+        return static_cast<unsigned>(((mask >> 7) * 0x0102040810204080ull) >> 56);
+    }
+
+    // One bits of a byte value: their number, the run below the first zero, the
+    // run above the last zero, and the number, bits and longest of the runs in
+    // between
+    struct BitRuns {
+        uint8_t ones;
+        uint8_t low;
+        uint8_t high;
+        uint8_t inner;
+        uint8_t innerOnes;
+        uint8_t longestInner;
+    };
+
+    static constexpr std::array<BitRuns, 256> BIT_RUNS = [] {
+        std::array<BitRuns, 256> table{};
+        for (unsigned bits = 0; bits < 256; ++bits) {
+            BitRuns& runs = table[bits];
+            for (unsigned k = 0; k < 8; ++k) {
+                runs.ones += (bits >> k) & 1;
+            }
+            while (runs.low < 8 && (bits >> runs.low) & 1) {
+                runs.low++;
+            }
+            while (runs.low < 8 && runs.high < 8 && (bits >> (7 - runs.high)) & 1) {
+                runs.high++;
+            }
+            uint8_t length = 0;
+            for (unsigned k = runs.low; k < 8u - runs.high; ++k) {
+                if ((bits >> k) & 1) {
+                    length++;
+                    runs.innerOnes++;
+                    continue;
+                }
+                runs.inner += length > 0;
+                runs.longestInner = std::max(runs.longestInner, length);
+                length = 0;
+            }
+        }
+        return table;
+    }();
+
+    // Whether the eight bytes at `bytes` are all printable ASCII or space, and
+    // if so the high-bit masks of their letters, digits and spaces
+    static bool printableWord(const unsigned char* bytes, uint64_t& letters, uint64_t& digits, uint64_t& spaces) {
+        // Byte k in bits 8k to 8k + 7 on any host; compilers turn this into one load
+        uint64_t word = static_cast<uint64_t>(bytes[0]) | static_cast<uint64_t>(bytes[1]) << 8
+                        | static_cast<uint64_t>(bytes[2]) << 16 | static_cast<uint64_t>(bytes[3]) << 24
+                        | static_cast<uint64_t>(bytes[4]) << 32 | static_cast<uint64_t>(bytes[5]) << 40
+                        | static_cast<uint64_t>(bytes[6]) << 48 | static_cast<uint64_t>(bytes[7]) << 56;
+
+        // High bit of a byte >= 0x80, >= 0x7F after adding 1, < 0x20 after adding
+        // 0x60 and inverting. Only a byte >= 0x80 can carry into the next one.
+        if (((word | (word + ONES) | ~(word + 0x60 * ONES)) & HIGH_BITS) != 0) {
+            return false;
+        }
+
+        // Setting bit 5 maps upper to lower case letters and no other byte into a-z
+        uint64_t folded = word | 0x20 * ONES;
+        letters = atLeast(folded, 'a') & ~atLeast(folded, 'z' + 1);
+        digits = atLeast(word, '0') & ~atLeast(word, '9' + 1);
+        spaces = ~atLeast(word, ' ' + 1) & HIGH_BITS;
+        return true;
+    }
+
+    static constexpr std::array<uint8_t, 256> BYTE_CLASSES = [] {
+        std::array<uint8_t, 256> classes{};
+        for (size_t c = 0; c < 256; ++c) {
+            if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+                classes[c] = Letter;
+            } else if (c >= '0' && c <= '9') {
+                classes[c] = Digit;
+            } else if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') {
+                classes[c] = Whitespace;
+            } else if (c < 0x20 || c == 0x7F) {
+                classes[c] = Control;
+            } else if (c < 0x80) {
+                classes[c] = Symbol;
+            } else if (c >= 0xC2 && c <= 0xF4) {
+                classes[c] = Lead;
+            } else {
+                classes[c] = Invalid;
+            }
+        }
+        return classes;
+    }();
+
+    // Length of the well-formed UTF-8 sequence at bytes[i], or 0. Rejects overlong
+    // forms, surrogates and code points above U+10FFFF.
+    static size_t validSequenceLength(const unsigned char* bytes, size_t length, size_t i) {
+        unsigned char lead = bytes[i];
+        size_t sequenceLength = LanguageDetector::utf8SequenceLength(lead);
+        if (i + sequenceLength > length) {
+            return 0;
+        }
+
+        unsigned char lo = 0x80;
+        unsigned char hi = 0xBF;
+        if (lead == 0xE0) lo = 0xA0;
+        if (lead == 0xED) hi = 0x9F;
+        if (lead == 0xF0) lo = 0x90;
+        if (lead == 0xF4) hi = 0x8F;
+        if (bytes[i + 1] < lo || bytes[i + 1] > hi) {
+            return 0;
+        }
+        for (size_t j = 2; j < sequenceLength; ++j) {
+            if ((bytes[i + j] & 0xC0) != 0x80) {
+                return 0;
+            }
+        }
+        return sequenceLength;
+    }
+};
+
+#endif // TEXT_FILTER_HPP
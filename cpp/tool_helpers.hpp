@@ -0,0 +1,89 @@
+#ifndef TOOL_HELPERS_HPP
+#define TOOL_HELPERS_HPP
+
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Helpers shared by the model tools that read the lingua test data and export
+// generated weight headers: factorize.cpp, prune.cpp, profile_buckets.cpp and
+// quantize.cpp.
+
+// Helper function to trim whitespace from a string
+inline std::string trim(const std::string& str) {
+    size_t start = str.find_first_not_of(" \t\n\r");
+    if (start == std::string::npos) return "";
+    size_t end = str.find_last_not_of(" \t\n\r");
+    return str.substr(start, end - start + 1);
+}
+
+// Non-empty trimmed lines of a file
+inline std::vector<std::string> readWordsFromFile(const std::string& filepath) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filepath);
+    }
+
+    std::vector<std::string> words;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::string word = trim(line);
+        if (!word.empty()) {
+            words.push_back(word);
+        }
+    }
+
+    return words;
+}
+
+// Array initializer body: floats as "0.123456f", by default 8 per line, integers 16
+template <typename T>
+void writeArray(std::ostream& file, const T* values, size_t n, size_t perLine = std::is_floating_point_v<T> ? 8 : 16) {
+    for (size_t i = 0; i < n; ++i) {
+        if (i % perLine == 0) {
+            file << "    ";
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            file << std::fixed << std::setprecision(6) << values[i] << "f";
+        } else {
+            file << static_cast<long long>(values[i]);
+        }
+        if (i + 1 < n) {
+            file << ",";
+        }
+        if (i % perLine == perLine - 1 || i + 1 == n) {
+            file << "\n";
+        } else {
+            file << " ";
+        }
+    }
+}
+
+template <typename T>
+void writeArray(std::ostream& file, const std::vector<T>& values) {
+    writeArray(file, values.data(), values.size());
+}
+
+// Lang enumerator of a language code, e.g. "de" -> "De"
+inline std::string enumName(std::string_view code) {
+    std::string name(code);
+    name[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(name[0])));
+    return name;
+}
+
+// The tool's command line, recorded in the headers it generates
+inline std::string commandLine(int argc, char* argv[]) {
+    std::string command = argc > 0 ? argv[0] : "";
+    for (int i = 1; i < argc; ++i) {
+        command += std::string(" ") + argv[i];
+    }
+    return command;
+}
+
+#endif // TOOL_HELPERS_HPP
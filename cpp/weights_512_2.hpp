@@ -3,7 +3,7 @@
 // Trained with 1000 samples per language (egalitarian)
 #pragma once
 #include <array>
-#include <string>
+#include <string_view>
 
 enum class Lang {
     Af,  // af
@@ -83,7 +83,7 @@ enum class Lang {
     Zu,  // zu
 };
 
-std::string three_letter_code(Lang language) {
+constexpr std::string_view three_letter_code(Lang language) {
     switch (language) {
         case Lang::Af: return "af";
         case Lang::Ar: return "ar";
@@ -164,7 +164,7 @@ std::string three_letter_code(Lang language) {
     return "unknown";
 }
 
-const std::array<Lang, 75> LANGUAGES = {
+constexpr std::array<Lang, 75> LANGUAGES = {
     Lang::Af,
     Lang::Ar,
     Lang::Az,
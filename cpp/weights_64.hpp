@@ -3,7 +3,7 @@
 // Trained with 1000 samples per language (egalitarian)
 #pragma once
 #include <array>
-#include <string>
+#include <string_view>
 
 enum class Lang {
     De,  // de
@@ -14,7 +14,7 @@ enum class Lang {
     Zh,  // zh
 };
 
-std::string three_letter_code(Lang language) {
+constexpr std::string_view three_letter_code(Lang language) {
     switch (language) {
         case Lang::De: return "de";
         case Lang::En: return "en";
@@ -26,7 +26,7 @@ std::string three_letter_code(Lang language) {
     return "unknown";
 }
 
-const std::array<Lang, 6> LANGUAGES = {
+constexpr std::array<Lang, 6> LANGUAGES = {
     Lang::De,
     Lang::En,
     Lang::Es,
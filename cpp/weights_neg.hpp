@@ -3,7 +3,13 @@
 // Trained with 1000 samples per language (egalitarian)
 #pragma once
 #include <array>
-#include <string>
+#include <string_view>
+
+// Declared in namespace neg_model so this model can be used next to another one
+// (see multi_model_detector.hpp). Unless WHICHLANG_NEG_MODEL_NAMESPACE_ONLY is
+// defined at the first include, the names are also global, as in the other
+// weights headers.
+namespace neg_model {
 
 enum class Lang {
     Af,  // af
@@ -83,7 +89,7 @@ enum class Lang {
     Zu,  // zu
 };
 
-std::string three_letter_code(Lang language) {
+constexpr std::string_view three_letter_code(Lang language) {
     switch (language) {
         case Lang::Af: return "af";
         case Lang::Ar: return "ar";
@@ -164,7 +170,7 @@ std::string three_letter_code(Lang language) {
     return "unknown";
 }
 
-const std::array<Lang, 75> LANGUAGES = {
+constexpr std::array<Lang, 75> LANGUAGES = {
     Lang::Af,
     Lang::Ar,
     Lang::Az,
@@ -38657,3 +38663,13 @@ const float INTERCEPTS[75] = {
     -260.597931f, -260.735779f, -260.771118f, -260.601288f, -260.925171f, -261.559509f, -260.818481f, -260.629730f,
     -260.490479f, -262.399323f, -260.778992f
 };
+
+}  // namespace neg_model
+
+#ifndef WHICHLANG_NEG_MODEL_NAMESPACE_ONLY
+using neg_model::Lang;
+using neg_model::three_letter_code;
+using neg_model::LANGUAGES;
+using neg_model::WEIGHTS;
+using neg_model::INTERCEPTS;
+#endif
@@ -0,0 +1,158 @@
+// Implementation of the C interface in whichlang.h.
+//
+// Build:
+//   g++ -std=c++17 -O2 -fPIC -shared -fvisibility=hidden -DWHICHLANG_BUILD -Wl,-soname,libwhichlang.so.1 whichlang.cpp -o libwhichlang.so.1
+//   ln -sf libwhichlang.so.1 libwhichlang.so
+#include "whichlang.h"
+#include "multi_model_detector.hpp"
+#include "language_codes.hpp"
+#include <array>
+#include <cstring>
+#include <new>
+
+namespace {
+
+constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+
+constexpr int32_t ENGLISH = static_cast<int32_t>(LanguageCodes::index(Lang::En));
+
+}  // namespace
+
+struct whichlang_detector {
+    LanguageModel model;
+    std::array<bool, NUM_LANGUAGES> allowed;
+    int32_t fallback;  // returned for texts without features
+
+    void detect(const char* text, size_t length, int32_t& outLanguage, float* outScores) const {
+        std::array<float, NUM_LANGUAGES> scores{};
+        uint32_t numFeatures = 0;
+        LanguageDetector::TokenizerState state;
+
+        LanguageDetector::emitBuckets(text, length, state, [&](uint32_t bucket) {
+            numFeatures++;
+            const float* row = model.weights + bucket * NUM_LANGUAGES;
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                scores[i] += row[i];
+            }
+        });
+
+        outLanguage = fallback;
+        if (numFeatures > 0) {
+            float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(numFeatures));
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                scores[i] = scores[i] * sqrtInvNumFeatures + model.intercepts[i];
+            }
+            // First maximum among the allowed languages, as std::max_element picks
+            int32_t best = -1;
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                if (allowed[i] && (best < 0 || scores[i] > scores[best])) {
+                    best = static_cast<int32_t>(i);
+                }
+            }
+            outLanguage = best;
+        }
+        if (outScores != nullptr) {
+            std::memcpy(outScores, scores.data(), sizeof(scores));
+        }
+    }
+};
+
+extern "C" {
+
+uint32_t whichlang_abi_version(void) {
+    return WHICHLANG_ABI_VERSION;
+}
+
+size_t whichlang_num_languages(void) {
+    return NUM_LANGUAGES;
+}
+
+const char* whichlang_language_code(int32_t language) {
+    if (language < 0 || static_cast<size_t>(language) >= NUM_LANGUAGES) {
+        return nullptr;
+    }
+    // Views of string literals, so null-terminated
+    return LanguageCodes::CODES[language].data();
+}
+
+int32_t whichlang_language_index(const char* code) {
+    if (code == nullptr) {
+        return -1;
+    }
+    std::optional<Lang> language = LanguageCodes::fromCode(code);
+    return language ? static_cast<int32_t>(LanguageCodes::index(*language)) : -1;
+}
+
+whichlang_status whichlang_detector_create(whichlang_model model, const char* const* allowlist,
+                                           size_t allowlist_size, whichlang_detector** out) {
+    if (out == nullptr || (allowlist == nullptr && allowlist_size > 0)) {
+        return WHICHLANG_INVALID_ARGUMENT;
+    }
+    *out = nullptr;
+
+    LanguageModel weights;
+    switch (model) {
+        case WHICHLANG_MODEL_DEFAULT:
+            weights = MODEL_PRIMARY;
+            break;
+        case WHICHLANG_MODEL_NEG:
+            weights = MODEL_NEG;
+            break;
+        default:
+            return WHICHLANG_UNKNOWN_MODEL;
+    }
+
+    std::array<bool, NUM_LANGUAGES> allowed;
+    allowed.fill(allowlist_size == 0);
+    for (size_t i = 0; i < allowlist_size; ++i) {
+        int32_t index = whichlang_language_index(allowlist[i]);
+        if (index < 0) {
+            return WHICHLANG_UNKNOWN_LANGUAGE;
+        }
+        allowed[index] = true;
+    }
+
+    // Default to English, or to the first allowed language if English is not allowed
+    int32_t fallback = ENGLISH;
+    for (size_t i = 0; i < NUM_LANGUAGES && !allowed[fallback]; ++i) {
+        if (allowed[i]) {
+            fallback = static_cast<int32_t>(i);
+        }
+    }
+
+    *out = new (std::nothrow) whichlang_detector{weights, allowed, fallback};
+    return *out != nullptr ? WHICHLANG_OK : WHICHLANG_OUT_OF_MEMORY;
+}
+
+void whichlang_detector_destroy(whichlang_detector* detector) {
+    delete detector;
+}
+
+whichlang_status whichlang_detect(const whichlang_detector* detector, const char* text, size_t length,
+                                  int32_t* out_language, float* out_scores) {
+    if (detector == nullptr || out_language == nullptr || (text == nullptr && length > 0)) {
+        return WHICHLANG_INVALID_ARGUMENT;
+    }
+    detector->detect(text, length, *out_language, out_scores);
+    return WHICHLANG_OK;
+}
+
+whichlang_status whichlang_detect_batch(const whichlang_detector* detector, const char* const* texts,
+                                        const size_t* lengths, size_t count,
+                                        int32_t* out_languages, float* out_scores) {
+    if (detector == nullptr || (count > 0 && (texts == nullptr || lengths == nullptr || out_languages == nullptr))) {
+        return WHICHLANG_INVALID_ARGUMENT;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (texts[i] == nullptr && lengths[i] > 0) {
+            return WHICHLANG_INVALID_ARGUMENT;
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        detector->detect(texts[i], lengths[i], out_languages[i],
+                         out_scores != nullptr ? out_scores + i * NUM_LANGUAGES : nullptr);
+    }
+    return WHICHLANG_OK;
+}
+
+}  // extern "C"
@@ -0,0 +1,88 @@
+/* C interface of the language detector, implemented in whichlang.cpp and built as
+ * libwhichlang.so. Usable from C and through the FFI of Rust, Go, Python, ...
+ *
+ * Texts are UTF-8 given as pointer and length. Languages are indices into the
+ * model's language list; whichlang_language_code() maps them to codes. No call
+ * allocates except whichlang_detector_create(), and no C++ exception crosses the
+ * interface: errors are returned as whichlang_status. Detectors are immutable after
+ * creation and may be shared between threads.
+ *
+ * Changes that break existing callers bump WHICHLANG_ABI_VERSION and the soname. */
+#ifndef WHICHLANG_H
+#define WHICHLANG_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WHICHLANG_ABI_VERSION 1
+
+/* Exported symbols. The library is built with WHICHLANG_BUILD, which selects
+ * dllexport over dllimport on Windows; WHICHLANG_STATIC marks a static build,
+ * for which the macro is empty. */
+#if defined(WHICHLANG_STATIC)
+#define WHICHLANG_API
+#elif defined(_WIN32)
+#if defined(WHICHLANG_BUILD)
+#define WHICHLANG_API __declspec(dllexport)
+#else
+#define WHICHLANG_API __declspec(dllimport)
+#endif
+#else
+#define WHICHLANG_API __attribute__((visibility("default")))
+#endif
+
+typedef enum whichlang_status {
+    WHICHLANG_OK = 0,
+    WHICHLANG_INVALID_ARGUMENT = 1,
+    WHICHLANG_UNKNOWN_MODEL = 2,
+    WHICHLANG_UNKNOWN_LANGUAGE = 3,  /* allowlist entry that is not a language code */
+    WHICHLANG_OUT_OF_MEMORY = 4
+} whichlang_status;
+
+typedef enum whichlang_model {
+    WHICHLANG_MODEL_DEFAULT = 0,  /* weights_4096 */
+    WHICHLANG_MODEL_NEG = 1       /* weights_neg, trained with negative sampling */
+} whichlang_model;
+
+typedef struct whichlang_detector whichlang_detector;
+
+/* WHICHLANG_ABI_VERSION the library was built with */
+WHICHLANG_API uint32_t whichlang_abi_version(void);
+
+/* Number of languages, i.e. the length of every score vector */
+WHICHLANG_API size_t whichlang_num_languages(void);
+
+/* Code of a language ("en", "de", ...), or NULL if out of range. The string is
+ * owned by the library and lives as long as it is loaded. */
+WHICHLANG_API const char* whichlang_language_code(int32_t language);
+
+/* Index of an ISO 639-1 or ISO 639-3 language code ("de" or "deu"), or -1 if unknown */
+WHICHLANG_API int32_t whichlang_language_index(const char* code);
+
+/* Creates a detector for `model`. If allowlist_size > 0, only the listed language
+ * codes can be returned. */
+WHICHLANG_API whichlang_status whichlang_detector_create(whichlang_model model, const char* const* allowlist,
+                                                         size_t allowlist_size, whichlang_detector** out);
+
+WHICHLANG_API void whichlang_detector_destroy(whichlang_detector* detector);
+
+/* Detects the language of text[0, length). If out_scores is not NULL it receives
+ * the whichlang_num_languages() final scores. */
+WHICHLANG_API whichlang_status whichlang_detect(const whichlang_detector* detector, const char* text, size_t length,
+                                                int32_t* out_language, float* out_scores);
+
+/* Detects `count` texts in one call. out_languages has `count` entries; out_scores,
+ * if not NULL, has count * whichlang_num_languages() entries, row by row. */
+WHICHLANG_API whichlang_status whichlang_detect_batch(const whichlang_detector* detector, const char* const* texts,
+                                                      const size_t* lengths, size_t count,
+                                                      int32_t* out_languages, float* out_scores);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WHICHLANG_H */
@@ -0,0 +1,196 @@
+// CPython extension module `whichlang`.
+//
+//   whichlang.detect(text) -> str
+//       Language code of one str or bytes (UTF-8) object.
+//   whichlang.detect_many(texts, threads=0) -> bytes
+//       One byte per element of the sequence `texts`: the index of its language in
+//       whichlang.LANGUAGES. threads=0 uses every thread the process may run on,
+//       see BatchDetector::defaultThreadCount.
+//   whichlang.LANGUAGES
+//       Tuple of language codes, indexed by the values detect_many returns.
+//
+// Both read each object's data in place, without converting it: bytes and ASCII
+// str as UTF-8, other str in the 1, 2 or 4 bytes per code point CPython stores
+// it in (see BatchText). detect_many then releases the GIL and scores the texts
+// on the work-stealing pool of BatchDetector, which splits very long UTF-8 texts
+// and groups short ones. The elements are held by a tuple for the duration of
+// the call, so the caller mutating the list cannot free them.
+//
+// Build:
+//   g++ -std=c++17 -O2 -shared -fPIC $(python3-config --includes) whichlang_python.cpp -o whichlang$(python3-config --extension-suffix)
+// Benchmark against a per-string loop: python3 bench_python.py
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+#include "batch_detector.hpp"
+#include "language_codes.hpp"
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+static_assert(NUM_LANGUAGES <= 256, "detect_many returns one byte per text");
+
+// View of the data of a str or bytes object, valid while the object is alive
+bool textView(PyObject* object, BatchText& text) {
+    if (PyUnicode_Check(object)) {
+#if PY_VERSION_HEX < 0x030C0000
+        if (PyUnicode_READY(object) < 0) {
+            return false;
+        }
+#endif
+        size_t length = static_cast<size_t>(PyUnicode_GET_LENGTH(object));
+        const void* data = PyUnicode_DATA(object);
+        switch (PyUnicode_KIND(object)) {
+            case PyUnicode_1BYTE_KIND:
+                text = BatchText(data, length,
+                                 PyUnicode_IS_ASCII(object) ? BatchText::Encoding::Utf8 : BatchText::Encoding::Latin1);
+                return true;
+            case PyUnicode_2BYTE_KIND:
+                text = BatchText(data, length, BatchText::Encoding::Utf16);
+                return true;
+            default:
+                text = BatchText(data, length, BatchText::Encoding::Utf32);
+                return true;
+        }
+    }
+    if (PyBytes_Check(object)) {
+        text = std::string_view(PyBytes_AS_STRING(object), static_cast<size_t>(PyBytes_GET_SIZE(object)));
+        return true;
+    }
+    PyErr_Format(PyExc_TypeError, "expected str or bytes, got %.200s", Py_TYPE(object)->tp_name);
+    return false;
+}
+
+PyObject* detect(PyObject*, PyObject* arg) {
+    BatchText text(std::string_view{});
+    if (!textView(arg, text)) {
+        return nullptr;
+    }
+
+    size_t index;
+    Py_BEGIN_ALLOW_THREADS
+    index = LanguageCodes::index(BatchDetector::detectLanguage(text));
+    Py_END_ALLOW_THREADS
+    std::string_view code = LanguageCodes::CODES[index];
+    return PyUnicode_FromStringAndSize(code.data(), static_cast<Py_ssize_t>(code.size()));
+}
+
+PyObject* detectMany(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"texts", "threads", nullptr};
+    PyObject* sequence;
+    Py_ssize_t threads = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|n:detect_many", const_cast<char**>(keywords),
+                                     &sequence, &threads)) {
+        return nullptr;
+    }
+
+    PyObject* items = PySequence_Tuple(sequence);
+    if (items == nullptr) {
+        return nullptr;
+    }
+    size_t n = static_cast<size_t>(PyTuple_GET_SIZE(items));
+    std::vector<BatchText> texts;
+    std::vector<Lang> languages;
+    try {
+        texts.assign(n, BatchText(std::string_view{}));
+        languages.resize(n);
+    } catch (const std::bad_alloc&) {
+        Py_DECREF(items);
+        return PyErr_NoMemory();
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (!textView(PyTuple_GET_ITEM(items, i), texts[i])) {
+            Py_DECREF(items);
+            return nullptr;
+        }
+    }
+
+    PyObject* result = PyBytes_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(n));
+    if (result == nullptr) {
+        Py_DECREF(items);
+        return nullptr;
+    }
+    uint8_t* out = reinterpret_cast<uint8_t*>(PyBytes_AS_STRING(result));
+
+    // No exception may leave the block with the GIL released: allocating tasks
+    // can throw bad_alloc and starting a thread system_error. They are raised
+    // once the GIL is held again.
+    enum class Failure { None, NoMemory, Runtime } failure = Failure::None;
+    std::string message;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        size_t numThreads = threads > 0 ? static_cast<size_t>(threads) : BatchDetector::defaultThreadCount();
+        BatchDetector::detectLanguages(texts.data(), n, languages.data(), numThreads);
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<uint8_t>(LanguageCodes::index(languages[i]));
+        }
+    } catch (const std::bad_alloc&) {
+        failure = Failure::NoMemory;
+    } catch (const std::exception& e) {
+        failure = Failure::Runtime;
+        try {
+            message = e.what();
+        } catch (const std::bad_alloc&) {
+            failure = Failure::NoMemory;
+        }
+    }
+    Py_END_ALLOW_THREADS
+
+    Py_DECREF(items);
+    if (failure != Failure::None) {
+        Py_DECREF(result);
+        if (failure == Failure::NoMemory) {
+            return PyErr_NoMemory();
+        }
+        PyErr_SetString(PyExc_RuntimeError, message.c_str());
+        return nullptr;
+    }
+    return result;
+}
+
+PyMethodDef METHODS[] = {
+    {"detect", detect, METH_O, "detect(text) -> language code of a str or UTF-8 bytes object"},
+    {"detect_many", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(detectMany)),
+     METH_VARARGS | METH_KEYWORDS,
+     "detect_many(texts, threads=0) -> bytes of indices into LANGUAGES, one per text"},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyModuleDef MODULE = {
+    PyModuleDef_HEAD_INIT, "whichlang", "Language detection", -1, METHODS,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_whichlang(void) {
+    PyObject* module = PyModule_Create(&MODULE);
+    if (module == nullptr) {
+        return nullptr;
+    }
+
+    PyObject* codes = PyTuple_New(NUM_LANGUAGES);
+    if (codes == nullptr) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+        std::string_view languageCode = LanguageCodes::CODES[i];
+        PyObject* code = PyUnicode_FromStringAndSize(languageCode.data(), static_cast<Py_ssize_t>(languageCode.size()));
+        if (code == nullptr) {
+            Py_DECREF(codes);
+            Py_DECREF(module);
+            return nullptr;
+        }
+        PyTuple_SET_ITEM(codes, i, code);
+    }
+    if (PyModule_AddObject(module, "LANGUAGES", codes) < 0) {
+        Py_DECREF(codes);
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
@@ -0,0 +1,158 @@
+#ifndef WORD_TAGGER_HPP
+#define WORD_TAGGER_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+#include <vector>
+#include "language_detector.hpp"
+
+struct WordLabel {
+    size_t begin;  // byte offsets of the word, [begin, end)
+    size_t end;
+    Lang language;
+};
+
+// Per-word language labels for code-switched text.
+//
+// One pass over the text computes each word's score vector with the detector's
+// tokenizer and weights (features completed by the punctuation after a word
+// count towards that word) and immediately runs one Viterbi step over the
+// languages. The transition model has one parameter: staying in a language is
+// free, switching costs `switchPenalty`, so each step is O(languages) instead of
+// O(languages^2). A backward pass over the stored backpointers then writes the
+// labels. Scratch buffers are owned by the tagger, allocated from `memory`, and
+// only grow, so once they fit the longest text seen, tag() does not allocate.
+class WordTagger {
+public:
+    static constexpr float DEFAULT_SWITCH_PENALTY = 4.0f;
+
+    explicit WordTagger(float switchPenalty = DEFAULT_SWITCH_PENALTY, size_t expectedWords = 256,
+                        std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : switchPenalty(switchPenalty), words(memory), backpointers(memory) {
+        words.reserve(expectedWords);
+        backpointers.reserve(expectedWords * NUM_LANGUAGES);
+    }
+
+    // Labels the words of `text` into out[0, capacity) and returns the number of
+    // words. If that is larger than `capacity`, only the first `capacity` labels
+    // are written.
+    size_t tag(std::string_view text, WordLabel* out, size_t capacity) {
+        words.clear();
+        backpointers.clear();
+        wordScores.fill(0.0f);
+        wordFeatures = 0;
+        inWord = false;
+
+        LanguageDetector::TokenizerState state;
+        size_t consumed = LanguageDetector::forEachCodepoint(text.data(), text.size(),
+                                                             [&](char32_t chr, size_t offset) {
+            bool wordCodepoint = LanguageDetector::isWordCodepoint(chr);
+            if (wordCodepoint && !inWord) {
+                closeWord();
+                words.push_back({offset, offset});
+                inWord = true;
+            } else if (!wordCodepoint && inWord) {
+                words.back().end = offset;
+                inWord = false;
+            }
+
+            // Features ending at punctuation belong to the word before it
+            LanguageDetector::emitBuckets(chr, state, [&](uint32_t bucket) {
+                wordFeatures++;
+                LanguageDetector::addBucket(wordScores, bucket);
+            });
+        });
+        if (inWord) {
+            words.back().end = consumed;
+        }
+        closeWord();
+
+        size_t numWords = words.size();
+        if (numWords == 0) {
+            return 0;
+        }
+
+        // Backtrack from the best final state
+        size_t lang = std::distance(delta.begin(), std::max_element(delta.begin(), delta.end()));
+        for (size_t w = numWords; w-- > 0;) {
+            if (w < capacity) {
+                out[w] = {words[w].begin, words[w].end, LANGUAGES[lang]};
+            }
+            if (w > 0) {
+                lang = backpointers[w * NUM_LANGUAGES + lang];
+            }
+        }
+        return numWords;
+    }
+
+    template <typename Allocator>
+    size_t tag(std::string_view text, std::vector<WordLabel, Allocator>& out) {
+        out.resize(text.size() / 2 + 1);
+        out.resize(tag(text, out.data(), out.size()));
+        return out.size();
+    }
+
+private:
+    static constexpr size_t NUM_LANGUAGES = LanguageDetector::NUM_LANGUAGES;
+    static_assert(NUM_LANGUAGES <= 256, "backpointers are stored as uint8_t");
+
+    struct WordRange {
+        size_t begin;
+        size_t end;
+    };
+
+    // Turns the features collected for the current word into its emission scores
+    // and advances the Viterbi recursion by one word
+    void closeWord() {
+        if (words.size() == backpointers.size() / NUM_LANGUAGES) {
+            // No open word: features before the first word are dropped
+            wordScores.fill(0.0f);
+            wordFeatures = 0;
+            return;
+        }
+
+        std::array<float, NUM_LANGUAGES> emission{};
+        if (wordFeatures > 0) {
+            float sqrtInvNumFeatures = 1.0f / std::sqrt(static_cast<float>(wordFeatures));
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                emission[i] = wordScores[i] * sqrtInvNumFeatures + INTERCEPTS[i];
+            }
+        }
+
+        size_t base = backpointers.size();
+        backpointers.resize(base + NUM_LANGUAGES);
+        if (base == 0) {
+            delta = emission;
+        } else {
+            size_t best = std::distance(delta.begin(), std::max_element(delta.begin(), delta.end()));
+            float switchScore = delta[best] - switchPenalty;
+            for (size_t i = 0; i < NUM_LANGUAGES; ++i) {
+                bool stay = delta[i] >= switchScore;
+                backpointers[base + i] = static_cast<uint8_t>(stay ? i : best);
+                delta[i] = (stay ? delta[i] : switchScore) + emission[i];
+            }
+        }
+
+        // Only differences between the entries matter: keeping the best at 0 stops
+        // the sums from growing with the number of words and losing float precision
+        float top = *std::max_element(delta.begin(), delta.end());
+        for (float& score : delta) {
+            score -= top;
+        }
+
+        wordScores.fill(0.0f);
+        wordFeatures = 0;
+    }
+
+    float switchPenalty;
+    std::pmr::vector<WordRange> words;
+    std::pmr::vector<uint8_t> backpointers;  // per word and language: best previous language
+    std::array<float, NUM_LANGUAGES> delta{};
+    std::array<float, NUM_LANGUAGES> wordScores{};
+    uint32_t wordFeatures = 0;
+    bool inWord = false;
+};
+
+#endif // WORD_TAGGER_HPP
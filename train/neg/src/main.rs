@@ -600,7 +600,17 @@ impl LanguageDetectorTrainer {
                 self.config.samples_per_language)?;
         writeln!(file, "#pragma once")?;
         writeln!(file, "#include <array>")?;
-        writeln!(file, "#include <string>")?;
+        writeln!(file, "#include <string_view>")?;
+        writeln!(file)?;
+
+        // Everything is declared in namespace neg_model, so the model can be included
+        // next to another weights header, and made global unless the includer asks
+        // for the namespace only
+        writeln!(file, "// Declared in namespace neg_model so this model can be used next to another one")?;
+        writeln!(file, "// (see multi_model_detector.hpp). Unless WHICHLANG_NEG_MODEL_NAMESPACE_ONLY is")?;
+        writeln!(file, "// defined at the first include, the names are also global, as in the other")?;
+        writeln!(file, "// weights headers.")?;
+        writeln!(file, "namespace neg_model {{")?;
         writeln!(file)?;
 
         // Generate enum for languages
@@ -614,7 +624,7 @@ impl LanguageDetectorTrainer {
         writeln!(file)?;
 
         // Generate three_letter_code function
-        writeln!(file, "std::string three_letter_code(Lang language) {{")?;
+        writeln!(file, "constexpr std::string_view three_letter_code(Lang language) {{")?;
         writeln!(file, "    switch (language) {{")?;
         for code in &self.language_codes {
             let enum_name = Self::lang_code_to_cpp_enum(code);
@@ -626,7 +636,7 @@ impl LanguageDetectorTrainer {
         writeln!(file)?;
 
         // Generate languages array
-        writeln!(file, "const std::array<Lang, {}> LANGUAGES = {{", self.language_codes.len())?;
+        writeln!(file, "constexpr std::array<Lang, {}> LANGUAGES = {{", self.language_codes.len())?;
         for code in &self.language_codes {
             let enum_name = Self::lang_code_to_cpp_enum(code);
             writeln!(file, "    Lang::{},", enum_name)?;
@@ -670,6 +680,14 @@ impl LanguageDetectorTrainer {
             }
         }
         writeln!(file, "}};")?;
+        writeln!(file)?;
+        writeln!(file, "}}  // namespace neg_model")?;
+        writeln!(file)?;
+        writeln!(file, "#ifndef WHICHLANG_NEG_MODEL_NAMESPACE_ONLY")?;
+        for name in ["Lang", "three_letter_code", "LANGUAGES", "WEIGHTS", "INTERCEPTS"] {
+            writeln!(file, "using neg_model::{};", name)?;
+        }
+        writeln!(file, "#endif")?;
 
         println!("Weights exported to {}", output_file);
         Ok(())
@@ -570,7 +570,7 @@ impl LanguageDetectorTrainer {
                 self.config.samples_per_language)?;
         writeln!(file, "#pragma once")?;
         writeln!(file, "#include <array>")?;
-        writeln!(file, "#include <string>")?;
+        writeln!(file, "#include <string_view>")?;
         writeln!(file)?;
 
         // Generate enum for languages
@@ -584,7 +584,7 @@ impl LanguageDetectorTrainer {
         writeln!(file)?;
 
         // Generate three_letter_code function
-        writeln!(file, "std::string three_letter_code(Lang language) {{")?;
+        writeln!(file, "constexpr std::string_view three_letter_code(Lang language) {{")?;
         writeln!(file, "    switch (language) {{")?;
         for code in &self.language_codes {
             let enum_name = Self::lang_code_to_cpp_enum(code);
@@ -596,7 +596,7 @@ impl LanguageDetectorTrainer {
         writeln!(file)?;
 
         // Generate languages array
-        writeln!(file, "const std::array<Lang, {}> LANGUAGES = {{", self.language_codes.len())?;
+        writeln!(file, "constexpr std::array<Lang, {}> LANGUAGES = {{", self.language_codes.len())?;
         for code in &self.language_codes {
             let enum_name = Self::lang_code_to_cpp_enum(code);
             writeln!(file, "    Lang::{},", enum_name)?;